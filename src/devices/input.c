@@ -41,6 +41,36 @@ input_getc (void)
   return key;
 }
 
+/* Retrieves up to SIZE keys from the input buffer into KEYS,
+   waiting for a key to be pressed if the buffer is empty.  Takes
+   whatever keys are already buffered in one pass, stopping early
+   after a carriage return or new-line so that a caller reading a
+   line does not take part of the next one.  SIZE must be
+   nonzero.  Returns the number of keys retrieved, which is
+   between 1 and SIZE. */
+size_t
+input_read (uint8_t *keys, size_t size) 
+{
+  enum intr_level old_level;
+  size_t cnt = 0;
+
+  ASSERT (size > 0);
+
+  old_level = intr_disable ();
+  do
+    {
+      uint8_t key = intq_getc (&buffer);
+      keys[cnt++] = key;
+      if (key == '\r' || key == '\n')
+        break;
+    }
+  while (cnt < size && !intq_empty (&buffer));
+  serial_notify ();
+  intr_set_level (old_level);
+
+  return cnt;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -74,6 +74,22 @@ intq_putc (struct intq *q, uint8_t byte)
   signal (q, &q->not_empty);
 }
 
+/* Sleeps until Q has room for another byte, without adding one.
+   Interrupts must be off, and this may not be called from an
+   interrupt handler. */
+void
+intq_wait_room (struct intq *q) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  while (intq_full (q))
+    {
+      ASSERT (!intr_context ());
+      lock_acquire (&q->lock);
+      wait (q, &q->not_full);
+      lock_release (&q->lock);
+    }
+}
+
 /* Returns the position after POS within an intq. */
 static int
 next (int pos) 
@@ -39,5 +39,6 @@ bool intq_empty (const struct intq *);
 bool intq_full (const struct intq *);
 uint8_t intq_getc (struct intq *);
 void intq_putc (struct intq *, uint8_t);
+void intq_wait_room (struct intq *);
 
 #endif /* devices/intq.h */
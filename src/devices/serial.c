@@ -129,6 +129,19 @@ serial_putc (uint8_t byte)
   intr_set_level (old_level);
 }
 
+/* Sleeps until serial_putc() can queue a byte for the interrupt
+   handler to send, rather than sending one by polling because
+   interrupts are off and the queue is full.  Interrupts must be
+   off, and this may not be called from an interrupt handler.
+   Returns at once if interrupt-driven I/O is not set up yet. */
+void
+serial_wait_room (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  if (mode == QUEUE)
+    intq_wait_room (&txq);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
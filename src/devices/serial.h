@@ -5,6 +5,7 @@
 
 void serial_init_queue (void);
 void serial_putc (uint8_t);
+void serial_wait_room (void);
 void serial_flush (void);
 void serial_notify (void);
 
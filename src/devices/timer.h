@@ -4,6 +4,8 @@
 #include <round.h>
 #include <stdint.h>
 
+struct thread;
+
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
@@ -15,6 +17,7 @@ int64_t timer_elapsed (int64_t);
 
 /* Sleep and yield the CPU to other threads. */
 void timer_sleep (int64_t ticks);
+void timer_wake (struct thread *);
 void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
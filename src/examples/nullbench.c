@@ -0,0 +1,37 @@
+/* nullbench.c
+
+   Times a loop of syscalls that fail right after dispatch. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Returns the processor's time-stamp counter, which counts
+   clock cycles. */
+static uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int iterations = 100000;
+  uint64_t start;
+  int i;
+
+  if (argc == 2)
+    iterations = atoi (argv[1]);
+
+  start = read_tsc ();
+  for (i = 0; i < iterations; i++)
+    tell (STDIN_FILENO);
+
+  printf ("nullbench: %d syscalls in %"PRIu64" cycles\n",
+          iterations, read_tsc () - start);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/* readbench.c
+
+   Times N child processes each rereading a file of its own. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+/* Maximum number of child processes. */
+#define MAX_CHILDREN 32
+
+/* Size of each child's file, in bytes. */
+#define FILE_SIZE 8192
+
+/* Number of times each child reads its whole file. */
+#define PASSES 64
+
+/* Returns the processor's time-stamp counter, which counts
+   clock cycles. */
+static uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Reads file NAME from start to end PASSES times. */
+static int
+child (const char *name)
+{
+  char buffer[512];
+  int fd, pass;
+
+  fd = open (name);
+  if (fd < 0)
+    {
+      printf ("%s: open failed\n", name);
+      return EXIT_FAILURE;
+    }
+
+  for (pass = 0; pass < PASSES; pass++)
+    {
+      seek (fd, 0);
+      while (read (fd, buffer, sizeof buffer) > 0)
+        continue;
+    }
+  close (fd);
+  return EXIT_SUCCESS;
+}
+
+/* Creates file NAME, FILE_SIZE bytes long, filled with
+   nonzero data. */
+static bool
+make_file (const char *name)
+{
+  char buffer[512];
+  int fd, ofs;
+
+  if (!create (name, FILE_SIZE))
+    return false;
+  fd = open (name);
+  if (fd < 0)
+    return false;
+
+  memset (buffer, 'x', sizeof buffer);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += sizeof buffer)
+    write (fd, buffer, sizeof buffer);
+  close (fd);
+  return true;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static char cmd_lines[MAX_CHILDREN][32];
+  const char *cmd_line_ptrs[MAX_CHILDREN];
+  pid_t children[MAX_CHILDREN];
+  int child_cnt = 8;
+  uint64_t start;
+  int i;
+
+  if (argc == 3 && !strcmp (argv[1], "child"))
+    return child (argv[2]);
+
+  if (argc == 2)
+    child_cnt = atoi (argv[1]);
+  if (child_cnt < 1 || child_cnt > MAX_CHILDREN)
+    {
+      printf ("usage: readbench [CHILDREN]\n");
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < child_cnt; i++)
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "rb-%d", i);
+      remove (name);
+      if (!make_file (name))
+        {
+          printf ("%s: create failed\n", name);
+          return EXIT_FAILURE;
+        }
+    }
+
+  /* Start all the children with one call, without waiting for
+     each to load before starting the next. */
+  start = read_tsc ();
+  for (i = 0; i < child_cnt; i++)
+    {
+      snprintf (cmd_lines[i], sizeof cmd_lines[i], "readbench child rb-%d", i);
+      cmd_line_ptrs[i] = cmd_lines[i];
+    }
+  spawn_many (cmd_line_ptrs, children, child_cnt);
+  for (i = 0; i < child_cnt; i++)
+    if (children[i] != PID_ERROR)
+      wait (children[i]);
+
+  printf ("readbench: %d children read %d bytes each in %"PRIu64" cycles\n",
+          child_cnt, FILE_SIZE * PASSES, read_tsc () - start);
+  return EXIT_SUCCESS;
+}
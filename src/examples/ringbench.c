@@ -0,0 +1,139 @@
+/* ringbench.c
+
+   Times small pread()s made one at a time or batched on a ring. */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include <syscall-nr.h>
+
+/* Size of the file read, in bytes. */
+#define FILE_SIZE 4096
+
+/* Size of each read, in bytes. */
+#define CHUNK_SIZE 16
+
+/* Kept page-aligned so that it occupies a single page. */
+static struct ring ring __attribute__ ((aligned (4096)));
+
+/* Returns the processor's time-stamp counter, which counts
+   clock cycles. */
+static uint64_t
+read_tsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Creates "rb-file", FILE_SIZE bytes long, and returns an open
+   descriptor for it, or -1 on failure. */
+static int
+make_file (void)
+{
+  char buffer[512];
+  int fd, ofs;
+
+  remove ("rb-file");
+  if (!create ("rb-file", FILE_SIZE))
+    return -1;
+  fd = open ("rb-file");
+  if (fd < 0)
+    return -1;
+
+  memset (buffer, 'x', sizeof buffer);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += sizeof buffer)
+    write (fd, buffer, sizeof buffer);
+  return fd;
+}
+
+/* Reads OPS chunks from FD one pread() at a time. */
+static void
+run_plain (int fd, int ops)
+{
+  char buffer[CHUNK_SIZE];
+  int i;
+
+  for (i = 0; i < ops; i++)
+    pread (fd, buffer, CHUNK_SIZE, i * CHUNK_SIZE % FILE_SIZE);
+}
+
+/* Reads OPS chunks from FD by queuing pread()s on the ring,
+   RING_SIZE at a time.  Returns the number that failed. */
+static int
+run_ring (int fd, int ops)
+{
+  static char buffer[RING_SIZE][CHUNK_SIZE];
+  int queued = 0, done = 0, failed = 0;
+
+  while (done < ops)
+    {
+      /* Fill the submission queue. */
+      while (queued < ops && ring.sq_tail - ring.sq_head < RING_SIZE)
+        {
+          struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_SIZE];
+          sqe->number = SYS_PREAD;
+          sqe->args[0] = fd;
+          sqe->args[1] = (uint32_t) buffer[ring.sq_tail % RING_SIZE];
+          sqe->args[2] = CHUNK_SIZE;
+          sqe->args[3] = queued * CHUNK_SIZE % FILE_SIZE;
+          sqe->user_data = queued;
+          ring.sq_tail++;
+          queued++;
+        }
+
+      if (ring_enter (&ring) < 0)
+        return ops;
+
+      /* Reap the completions. */
+      for (; ring.cq_head != ring.cq_tail; ring.cq_head++)
+        {
+          if (ring.cq[ring.cq_head % RING_SIZE].result != CHUNK_SIZE)
+            failed++;
+          done++;
+        }
+    }
+  return failed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int ops = 20000;
+  bool use_ring;
+  uint64_t start, cycles;
+  int failed = 0;
+  int fd;
+
+  if (argc < 2 || argc > 3
+      || (strcmp (argv[1], "ring") && strcmp (argv[1], "plain")))
+    {
+      printf ("usage: ringbench ring|plain [OPERATIONS]\n");
+      return EXIT_FAILURE;
+    }
+  use_ring = !strcmp (argv[1], "ring");
+  if (argc == 3)
+    ops = atoi (argv[2]);
+
+  fd = make_file ();
+  if (fd < 0)
+    {
+      printf ("rb-file: create failed\n");
+      return EXIT_FAILURE;
+    }
+
+  start = read_tsc ();
+  if (use_ring)
+    failed = run_ring (fd, ops);
+  else
+    run_plain (fd, ops);
+  cycles = read_tsc () - start;
+
+  if (failed)
+    printf ("ringbench: %d reads failed\n", failed);
+  printf ("ringbench: %d reads of %d bytes in %"PRIu64" cycles\n",
+          ops, CHUNK_SIZE, cycles);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,484 @@
+#include "filesys/cache.h"
+#include <debug.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/filesys.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Number of sectors held in the buffer cache. */
+#define CACHE_SIZE 64
+
+/* Maximum number of outstanding read-ahead requests.
+   Requests made while the queue is full are dropped. */
+#define READAHEAD_QUEUE_SIZE 32
+
+/* Timer ticks between passes of the write-behind thread. */
+#define WRITE_BEHIND_TICKS TIMER_FREQ
+
+/* A cached copy of one file system sector. */
+struct cache_entry
+  {
+    block_sector_t sector;              /* Sector cached here. */
+    bool valid;                         /* Holds a sector? */
+    bool dirty;                         /* Modified since read from disk? */
+    bool accessed;                      /* Used since clock hand passed? */
+    unsigned pin_cnt;                   /* Nonzero: must not be evicted. */
+    bool busy;                          /* Being read or written? */
+    struct condition io_done;           /* Signaled when BUSY clears. */
+    uint8_t data[BLOCK_SECTOR_SIZE];    /* Sector contents. */
+  };
+
+/* The buffer cache. */
+static struct cache_entry cache[CACHE_SIZE];
+
+/* Protects every entry in CACHE and CLOCK_HAND.  The lock is not
+   held while an entry's data moves to or from disk: the entry is
+   marked busy instead, and other threads that need it wait on
+   its IO_DONE condition, so that threads using other sectors are
+   not held up by the disk. */
+static struct lock cache_lock;
+
+/* Next entry to consider for eviction. */
+static size_t clock_hand;
+
+/* Sectors waiting to be prefetched by the read-ahead thread,
+   as a circular queue protected by READAHEAD_LOCK. */
+static block_sector_t readahead_queue[READAHEAD_QUEUE_SIZE];
+static size_t readahead_head;           /* Next free slot. */
+static size_t readahead_cnt;            /* Number of queued sectors. */
+static struct lock readahead_lock;
+static struct condition readahead_ready;
+
+/* The write-behind thread, once it has started running.
+   cache_done() sets WRITE_BEHIND_STOP and wakes it to make it
+   exit, and it ups WRITE_BEHIND_DONE on its way out. */
+static struct thread *write_behind;
+static bool write_behind_stop;
+static struct semaphore write_behind_done;
+
+/* True once cache_init() has run.  filesys_done() is called on
+   every power-off, including ones that happen before the file
+   system was ever set up. */
+static bool cache_initialized;
+
+/* Statistics, protected by CACHE_LOCK. */
+static long long hit_cnt;               /* # of reads/writes found cached. */
+static long long miss_cnt;              /* # of reads/writes that missed. */
+static long long prefetch_cnt;          /* # of sectors read ahead. */
+static long long write_back_cnt;        /* # of sectors written to disk. */
+
+static thread_func readahead_thread NO_RETURN;
+static thread_func write_behind_thread;
+static struct cache_entry *cache_lookup (block_sector_t);
+static struct cache_entry *cache_get (block_sector_t, bool fill);
+static struct cache_entry *cache_evict (void);
+static void cache_write_back (struct cache_entry *);
+static void cache_io (struct cache_entry *, bool write);
+
+/* Initializes the buffer cache. */
+void
+cache_init (void)
+{
+  size_t i;
+
+  lock_init (&cache_lock);
+  for (i = 0; i < CACHE_SIZE; i++)
+    {
+      cache[i].valid = false;
+      cache[i].dirty = false;
+      cache[i].accessed = false;
+      cache[i].pin_cnt = 0;
+      cache[i].busy = false;
+      cond_init (&cache[i].io_done);
+    }
+  clock_hand = 0;
+
+  lock_init (&readahead_lock);
+  cond_init (&readahead_ready);
+  readahead_head = readahead_cnt = 0;
+  write_behind_stop = false;
+  sema_init (&write_behind_done, 0);
+  thread_create ("readahead", PRI_DEFAULT, readahead_thread, NULL);
+  thread_create ("write-behind", PRI_DEFAULT, write_behind_thread, NULL);
+  cache_initialized = true;
+}
+
+/* Shuts down the buffer cache.  Stops the write-behind thread,
+   so that it cannot be writing to disk during or after the final
+   pass, then writes every dirty sector back to disk.  Does
+   nothing if cache_init() was never called. */
+void
+cache_done (void)
+{
+  if (!cache_initialized)
+    return;
+
+  write_behind_stop = true;
+  barrier ();
+  if (write_behind != NULL)
+    timer_wake (write_behind);
+  sema_down (&write_behind_done);
+  cache_flush ();
+}
+
+/* Prints buffer cache statistics. */
+void
+cache_print_stats (void)
+{
+  printf ("Cache: %lld hits, %lld misses, %lld prefetches, "
+          "%lld write-backs\n",
+          hit_cnt, miss_cnt, prefetch_cnt, write_back_cnt);
+}
+
+/* Writes every dirty sector in the cache back to disk, in
+   ascending sector order to keep disk head movement down.  The
+   cache lock is dropped between sectors so that readers and
+   writers are not held up for the whole pass. */
+void
+cache_flush (void)
+{
+  block_sector_t next = 0;
+
+  for (;;)
+    {
+      struct cache_entry *e = NULL;
+      size_t i;
+
+      lock_acquire (&cache_lock);
+      for (i = 0; i < CACHE_SIZE; i++)
+        if (cache[i].valid && cache[i].dirty && cache[i].sector >= next
+            && (e == NULL || cache[i].sector < e->sector))
+          e = &cache[i];
+      if (e == NULL)
+        {
+          lock_release (&cache_lock);
+          break;
+        }
+      if (e->busy)
+        {
+          /* Already being written back.  Look again once it is
+             done. */
+          cond_wait (&e->io_done, &cache_lock);
+          lock_release (&cache_lock);
+          continue;
+        }
+      next = e->sector + 1;
+      cache_write_back (e);
+      lock_release (&cache_lock);
+    }
+}
+
+/* Reads SIZE bytes starting at byte SECTOR_OFS within SECTOR
+   into BUFFER, going to disk only if SECTOR is not cached. */
+void
+cache_read (block_sector_t sector, void *buffer, int sector_ofs, int size)
+{
+  struct cache_entry *e;
+
+  ASSERT (sector_ofs >= 0 && size >= 0);
+  ASSERT (sector_ofs + size <= BLOCK_SECTOR_SIZE);
+
+  lock_acquire (&cache_lock);
+  e = cache_get (sector, true);
+  memcpy (buffer, e->data + sector_ofs, size);
+  lock_release (&cache_lock);
+}
+
+/* Writes SIZE bytes from BUFFER into SECTOR starting at byte
+   SECTOR_OFS.  The data only reaches the disk when the sector
+   is evicted or the cache is flushed.  The old contents of
+   SECTOR are read in first unless the write covers all of it. */
+void
+cache_write (block_sector_t sector, const void *buffer, int sector_ofs,
+             int size)
+{
+  struct cache_entry *e;
+
+  ASSERT (sector_ofs >= 0 && size >= 0);
+  ASSERT (sector_ofs + size <= BLOCK_SECTOR_SIZE);
+
+  lock_acquire (&cache_lock);
+  e = cache_get (sector, size < BLOCK_SECTOR_SIZE);
+  memcpy (e->data + sector_ofs, buffer, size);
+  e->dirty = true;
+  lock_release (&cache_lock);
+}
+
+/* Copies SIZE bytes starting at byte SRC_OFS within SRC_SECTOR
+   to byte DST_OFS within DST_SECTOR, straight from one cache
+   entry to the other.  Either sector is read in first if it is
+   not cached, except that DST_SECTOR is not read if the copy
+   covers all of it. */
+void
+cache_copy (block_sector_t dst_sector, int dst_ofs,
+            block_sector_t src_sector, int src_ofs, int size)
+{
+  struct cache_entry *src, *dst;
+
+  ASSERT (dst_ofs >= 0 && src_ofs >= 0 && size >= 0);
+  ASSERT (dst_ofs + size <= BLOCK_SECTOR_SIZE);
+  ASSERT (src_ofs + size <= BLOCK_SECTOR_SIZE);
+
+  lock_acquire (&cache_lock);
+  src = cache_get (src_sector, true);
+
+  /* Keep SRC from being evicted to make room for DST, including
+     while cache_get() waits for the disk. */
+  src->pin_cnt++;
+  dst = cache_get (dst_sector, size < BLOCK_SECTOR_SIZE);
+  src->pin_cnt--;
+
+  memmove (dst->data + dst_ofs, src->data + src_ofs, size);
+  dst->dirty = true;
+  lock_release (&cache_lock);
+}
+
+/* Asks the read-ahead thread to bring SECTOR into the cache in
+   the background.  Returns without waiting for the disk. */
+void
+cache_readahead (block_sector_t sector)
+{
+  lock_acquire (&readahead_lock);
+  if (readahead_cnt < READAHEAD_QUEUE_SIZE)
+    {
+      size_t tail = (readahead_head + READAHEAD_QUEUE_SIZE - readahead_cnt)
+                    % READAHEAD_QUEUE_SIZE;
+      size_t i;
+
+      /* Skip sectors that are already queued. */
+      for (i = 0; i < readahead_cnt; i++)
+        if (readahead_queue[(tail + i) % READAHEAD_QUEUE_SIZE] == sector)
+          break;
+      if (i == readahead_cnt)
+        {
+          readahead_queue[readahead_head] = sector;
+          readahead_head = (readahead_head + 1) % READAHEAD_QUEUE_SIZE;
+          readahead_cnt++;
+          cond_signal (&readahead_ready, &readahead_lock);
+        }
+    }
+  lock_release (&readahead_lock);
+}
+
+/* Tells the cache that SECTOR will not be needed again soon.  If
+   it is cached, its entry loses its second chance, so the clock
+   hand reuses it the next time around instead of an entry still
+   in use.  A dirty entry is written back as usual when it is
+   reused. */
+void
+cache_dontneed (block_sector_t sector)
+{
+  struct cache_entry *e;
+
+  lock_acquire (&cache_lock);
+  e = cache_lookup (sector);
+  if (e != NULL)
+    e->accessed = false;
+  lock_release (&cache_lock);
+}
+
+/* Read-ahead thread.  Loads queued sectors into the cache so
+   that a process reading sequentially finds them there. */
+static void
+readahead_thread (void *aux UNUSED)
+{
+  for (;;)
+    {
+      block_sector_t sector;
+
+      lock_acquire (&readahead_lock);
+      while (readahead_cnt == 0)
+        cond_wait (&readahead_ready, &readahead_lock);
+      sector = readahead_queue[(readahead_head + READAHEAD_QUEUE_SIZE
+                                - readahead_cnt) % READAHEAD_QUEUE_SIZE];
+      readahead_cnt--;
+      lock_release (&readahead_lock);
+
+      lock_acquire (&cache_lock);
+      if (cache_lookup (sector) == NULL)
+        {
+          struct cache_entry *e = cache_evict ();
+
+          /* Another thread may have loaded SECTOR while
+             cache_evict() wrote back a dirty entry. */
+          if (cache_lookup (sector) == NULL)
+            {
+              e->sector = sector;
+              e->valid = true;
+              e->dirty = false;
+              e->accessed = true;
+              cache_io (e, false);
+              prefetch_cnt++;
+            }
+        }
+      lock_release (&cache_lock);
+    }
+}
+
+/* Write-behind thread.  Periodically writes dirty sectors back
+   to disk, so that data reaches the disk even if it stays in the
+   cache, without making writers wait for the disk.  Repeated
+   writes to a sector between passes cost a single disk write.
+   Exits as soon as cache_done() asks it to, without waiting
+   out the rest of its sleep. */
+static void
+write_behind_thread (void *aux UNUSED)
+{
+  /* cache_done() sets WRITE_BEHIND_STOP before it looks at
+     WRITE_BEHIND, and we do the reverse, so either it wakes us
+     or we see the flag before going to sleep. */
+  write_behind = thread_current ();
+  barrier ();
+  while (!write_behind_stop)
+    {
+      timer_sleep (WRITE_BEHIND_TICKS);
+      if (write_behind_stop)
+        break;
+      cache_flush ();
+    }
+  sema_up (&write_behind_done);
+}
+
+/* Returns the entry caching SECTOR, or a null pointer if SECTOR
+   is not cached.  The cache lock must be held. */
+static struct cache_entry *
+cache_lookup (block_sector_t sector)
+{
+  size_t i;
+
+  for (i = 0; i < CACHE_SIZE; i++)
+    if (cache[i].valid && cache[i].sector == sector)
+      return &cache[i];
+  return NULL;
+}
+
+/* Returns the entry caching SECTOR, loading it into the cache if
+   necessary.  If FILL is false the caller is about to overwrite
+   the whole sector, so a newly loaded entry is not read from
+   disk.  The returned entry is not busy.  The cache lock must be
+   held, but may be released and reacquired while waiting for the
+   disk. */
+static struct cache_entry *
+cache_get (block_sector_t sector, bool fill)
+{
+  struct cache_entry *e;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+
+  for (;;)
+    {
+      e = cache_lookup (sector);
+      if (e == NULL)
+        {
+          e = cache_evict ();
+
+          /* Another thread may have loaded SECTOR while
+             cache_evict() wrote back a dirty entry.  If so, leave
+             E free and use that thread's entry. */
+          if (cache_lookup (sector) != NULL)
+            continue;
+
+          miss_cnt++;
+          e->sector = sector;
+          e->valid = true;
+          e->dirty = false;
+          if (fill)
+            cache_io (e, false);
+          break;
+        }
+      else if (e->busy)
+        {
+          /* E may hold a different sector by the time its I/O is
+             done, so look SECTOR up again. */
+          cond_wait (&e->io_done, &cache_lock);
+        }
+      else
+        {
+          hit_cnt++;
+          break;
+        }
+    }
+  e->accessed = true;
+  return e;
+}
+
+/* Chooses an entry to reuse with the clock algorithm, writes it
+   back if it is dirty, and returns it marked invalid.
+   The cache lock must be held, but may be released and
+   reacquired while waiting for the disk. */
+static struct cache_entry *
+cache_evict (void)
+{
+  struct cache_entry *e;
+  size_t skip_cnt = 0;
+
+  for (;;)
+    {
+      e = &cache[clock_hand];
+      clock_hand = (clock_hand + 1) % CACHE_SIZE;
+
+      if (e->busy || e->pin_cnt > 0)
+        {
+          /* If every entry is busy or pinned, wait for some I/O
+             to finish before going around again. */
+          if (++skip_cnt >= CACHE_SIZE && e->busy)
+            {
+              cond_wait (&e->io_done, &cache_lock);
+              skip_cnt = 0;
+            }
+          continue;
+        }
+      skip_cnt = 0;
+
+      if (!e->valid)
+        break;
+      if (!e->accessed)
+        {
+          /* No thread can use E while it is written back, because
+             it is busy, so it is still ours to take afterward. */
+          cache_write_back (e);
+          break;
+        }
+      e->accessed = false;
+    }
+  e->valid = false;
+  return e;
+}
+
+/* Writes E back to disk if it is dirty.  The cache lock must be
+   held, but is released while waiting for the disk. */
+static void
+cache_write_back (struct cache_entry *e)
+{
+  if (e->valid && e->dirty)
+    {
+      cache_io (e, true);
+      e->dirty = false;
+      write_back_cnt++;
+    }
+}
+
+/* Writes E's data to its sector on disk if WRITE is true, or
+   reads it in otherwise.  E is marked busy for the duration, and
+   the cache lock, which must be held, is released, so that other
+   threads can use the rest of the cache meanwhile.  Threads that
+   need E itself wait until the transfer is done. */
+static void
+cache_io (struct cache_entry *e, bool write)
+{
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+  ASSERT (!e->busy);
+
+  e->busy = true;
+  lock_release (&cache_lock);
+  if (write)
+    block_write (fs_device, e->sector, e->data);
+  else
+    block_read (fs_device, e->sector, e->data);
+  lock_acquire (&cache_lock);
+  e->busy = false;
+  cond_broadcast (&e->io_done, &cache_lock);
+}
@@ -0,0 +1,18 @@
+#ifndef FILESYS_CACHE_H
+#define FILESYS_CACHE_H
+
+#include "devices/block.h"
+
+void cache_init (void);
+void cache_done (void);
+void cache_flush (void);
+void cache_print_stats (void);
+void cache_read (block_sector_t, void *buffer, int sector_ofs, int size);
+void cache_write (block_sector_t, const void *buffer, int sector_ofs,
+                  int size);
+void cache_copy (block_sector_t dst, int dst_ofs,
+                 block_sector_t src, int src_ofs, int size);
+void cache_readahead (block_sector_t);
+void cache_dontneed (block_sector_t);
+
+#endif /* filesys/cache.h */
@@ -1,8 +1,21 @@
 #include "filesys/file.h"
+#include <advice.h>
 #include <debug.h>
+#include <iovec.h>
+#include <round.h>
 #include <stdio.h>
+#include "devices/block.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Number of sectors to prefetch past the end of each sequential
+   read. */
+#define READAHEAD_SECTORS 8
+
+/* Number of sectors to prefetch past the end of every read from
+   a file advised ADV_SEQUENTIAL. */
+#define SEQUENTIAL_READAHEAD_SECTORS (2 * READAHEAD_SECTORS)
 
 /* An open file. */
 struct file 
@@ -10,8 +23,13 @@ struct file
     struct inode *inode;        /* File's inode. */
     off_t pos;                  /* Current position. */
     bool deny_write;            /* Has file_deny_write() been called? */
+    off_t readahead_pos;        /* Where the last file_read() ended. */
+    int advice;                 /* Access pattern, as an ADV_* value. */
+    struct lock lock;           /* Protects pos, readahead_pos, advice. */
   };
 
+static int readahead_sectors (const struct file *, bool sequential);
+
 /* Opens a file for the given INODE, of which it takes ownership,
    and returns the new file.  Returns a null pointer if an
    allocation fails or if INODE is null. */
@@ -24,6 +42,9 @@ file_open (struct inode *inode)
       file->inode = inode;
       file->pos = 0;
       file->deny_write = false;
+      file->readahead_pos = 0;
+      file->advice = ADV_NORMAL;
+      lock_init (&file->lock);
       return file;
     }
   else
@@ -65,12 +86,26 @@ file_get_inode (struct file *file)
    starting at the file's current position.
    Returns the number of bytes actually read,
    which may be less than SIZE if end of file is reached.
-   Advances FILE's position by the number of bytes read. */
+   Advances FILE's position by the number of bytes read.
+   A read that begins where the previous one ended is taken as
+   part of a sequential scan, and the sectors that follow it are
+   prefetched into the buffer cache, unless FILE has been advised
+   otherwise with file_advise(). */
 off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
-  off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+  bool sequential;
+  off_t bytes_read;
+
+  lock_acquire (&file->lock);
+  sequential = file->pos == file->readahead_pos;
+  bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_read;
+  file->readahead_pos = file->pos;
+  if (bytes_read > 0)
+    inode_readahead (file->inode, ROUND_UP (file->pos, BLOCK_SECTOR_SIZE),
+                     readahead_sectors (file, sequential));
+  lock_release (&file->lock);
   return bytes_read;
 }
 
@@ -85,6 +120,39 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs)
   return inode_read_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Reads from FILE into the IOVCNT buffers in IOV, in order,
+   starting at the file's current position.  The whole transfer
+   is done under one acquisition of FILE's lock, so it reads one
+   contiguous range of the file even if other threads share FILE.
+   Returns the number of bytes actually read, which may be less
+   than the total size of the buffers if end of file is reached.
+   Advances FILE's position by the number of bytes read. */
+off_t
+file_readv (struct file *file, const struct iovec *iov, int iovcnt) 
+{
+  bool sequential;
+  off_t bytes_read = 0;
+  int i;
+
+  lock_acquire (&file->lock);
+  sequential = file->pos == file->readahead_pos;
+  for (i = 0; i < iovcnt; i++)
+    {
+      off_t chunk = inode_read_at (file->inode, iov[i].iov_base,
+                                   iov[i].iov_len, file->pos);
+      file->pos += chunk;
+      bytes_read += chunk;
+      if (chunk < (off_t) iov[i].iov_len)
+        break;
+    }
+  file->readahead_pos = file->pos;
+  if (bytes_read > 0)
+    inode_readahead (file->inode, ROUND_UP (file->pos, BLOCK_SECTOR_SIZE),
+                     readahead_sectors (file, sequential));
+  lock_release (&file->lock);
+  return bytes_read;
+}
+
 /* Writes SIZE bytes from BUFFER into FILE,
    starting at the file's current position.
    Returns the number of bytes actually written,
@@ -95,8 +163,12 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs)
 off_t
 file_write (struct file *file, const void *buffer, off_t size) 
 {
-  off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+  off_t bytes_written;
+
+  lock_acquire (&file->lock);
+  bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_written;
+  lock_release (&file->lock);
   return bytes_written;
 }
 
@@ -114,6 +186,104 @@ file_write_at (struct file *file, const void *buffer, off_t size,
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Writes the IOVCNT buffers in IOV, in order, into FILE,
+   starting at the file's current position.  As with
+   file_readv(), FILE's lock is held for the whole transfer, so
+   the data lands in one contiguous range of the file.
+   Returns the number of bytes actually written, which may be
+   less than the total size of the buffers if end of file is
+   reached.  Advances FILE's position by the number of bytes
+   written. */
+off_t
+file_writev (struct file *file, const struct iovec *iov, int iovcnt) 
+{
+  off_t bytes_written = 0;
+  int i;
+
+  lock_acquire (&file->lock);
+  for (i = 0; i < iovcnt; i++)
+    {
+      off_t chunk = inode_write_at (file->inode, iov[i].iov_base,
+                                    iov[i].iov_len, file->pos);
+      file->pos += chunk;
+      bytes_written += chunk;
+      if (chunk < (off_t) iov[i].iov_len)
+        break;
+    }
+  lock_release (&file->lock);
+  return bytes_written;
+}
+
+/* Copies SIZE bytes from SRC, starting at its current position,
+   into DST at its current position, without passing the data
+   through a caller's buffer.  Returns the number of bytes
+   actually copied, which may be less than SIZE if end of either
+   file is reached.  Advances both files' positions by the number
+   of bytes copied.  SRC and DST must be different files, though
+   they may have the same inode. */
+off_t
+file_copy (struct file *dst, struct file *src, off_t size)
+{
+  /* Lock the two files in a fixed order, so that copies in
+     opposite directions cannot deadlock. */
+  struct file *first = dst < src ? dst : src;
+  struct file *second = dst < src ? src : dst;
+  off_t bytes_copied;
+
+  ASSERT (dst != src);
+
+  lock_acquire (&first->lock);
+  lock_acquire (&second->lock);
+  bytes_copied = inode_copy (dst->inode, dst->pos, src->inode, src->pos,
+                             size);
+  src->pos += bytes_copied;
+  dst->pos += bytes_copied;
+  lock_release (&second->lock);
+  lock_release (&first->lock);
+  return bytes_copied;
+}
+
+/* Tells the file system how FILE will be read.  ADVICE is one of
+   the ADV_* values in lib/advice.h.  ADV_NORMAL, ADV_RANDOM,
+   and ADV_SEQUENTIAL apply to all later reads from FILE: the
+   first reads ahead only after a read that continues the one
+   before it, the second never reads ahead, and the third always
+   reads further ahead than usual.  ADV_WILLNEED and ADV_DONTNEED
+   apply to the LENGTH bytes starting at OFFSET, or to the rest
+   of the file if LENGTH is 0: the first starts reading them into
+   the buffer cache, and the second lets the cache reuse their
+   entries before others. */
+void
+file_advise (struct file *file, off_t offset, off_t length, int advice) 
+{
+  off_t end = file_length (file);
+  off_t start = ROUND_DOWN (offset, BLOCK_SECTOR_SIZE);
+  int sectors;
+
+  ASSERT (offset >= 0 && length >= 0);
+
+  if (length != 0 && length < end - offset)
+    end = offset + length;
+  sectors = end > start ? DIV_ROUND_UP (end - start, BLOCK_SECTOR_SIZE) : 0;
+
+  switch (advice) 
+    {
+    case ADV_WILLNEED:
+      inode_readahead (file->inode, start, sectors);
+      break;
+
+    case ADV_DONTNEED:
+      inode_dontneed (file->inode, start, sectors);
+      break;
+
+    default:
+      lock_acquire (&file->lock);
+      file->advice = advice;
+      lock_release (&file->lock);
+      break;
+    }
+}
+
 /* Prevents write operations on FILE's underlying inode
    until file_allow_write() is called or FILE is closed. */
 void
@@ -156,7 +326,9 @@ file_seek (struct file *file, off_t new_pos)
 {
   ASSERT (file != NULL);
   ASSERT (new_pos >= 0);
+  lock_acquire (&file->lock);
   file->pos = new_pos;
+  lock_release (&file->lock);
 }
 
 /* Returns the current position in FILE as a byte offset from the
@@ -164,6 +336,25 @@ file_seek (struct file *file, off_t new_pos)
 off_t
 file_tell (struct file *file) 
 {
+  off_t pos;
+
   ASSERT (file != NULL);
-  return file->pos;
+  lock_acquire (&file->lock);
+  pos = file->pos;
+  lock_release (&file->lock);
+  return pos;
+}
+
+/* Returns the number of sectors to prefetch after a read from
+   FILE that continued the previous read if SEQUENTIAL is true.
+   FILE's lock must be held. */
+static int
+readahead_sectors (const struct file *file, bool sequential) 
+{
+  if (file->advice == ADV_SEQUENTIAL)
+    return SEQUENTIAL_READAHEAD_SECTORS;
+  else if (file->advice == ADV_RANDOM || !sequential)
+    return 0;
+  else
+    return READAHEAD_SECTORS;
 }
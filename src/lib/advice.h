@@ -0,0 +1,11 @@
+#ifndef __LIB_ADVICE_H
+#define __LIB_ADVICE_H
+
+/* Advice for madvise() and fadvise(). */
+#define ADV_NORMAL 0            /* No particular access pattern. */
+#define ADV_RANDOM 1            /* Random access: do not read ahead. */
+#define ADV_SEQUENTIAL 2        /* Sequential access: read further ahead. */
+#define ADV_WILLNEED 3          /* Range will be needed soon. */
+#define ADV_DONTNEED 4          /* Range will not be needed soon. */
+
+#endif /* lib/advice.h */
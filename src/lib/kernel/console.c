@@ -1,14 +1,22 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 
 static void vprintf_helper (char, void *);
 static void putchar_have_lock (uint8_t c);
+static void write_have_lock (const uint8_t *, size_t);
+static void ring_append (const uint8_t *, size_t);
+static bool ring_drain_one (void);
+static void ring_flush (void);
+static void putchar_sync (uint8_t c);
+static thread_func console_thread NO_RETURN;
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -59,6 +67,34 @@ static int console_lock_depth;
 /* Number of characters written to console. */
 static int64_t write_cnt;
 
+/* Console output ring.
+
+   Writing a character straight to the serial port means waiting
+   for a 9600 bps line, and every thread that prints waits its
+   turn behind the console lock.  Once console_init_queue() has
+   been called, output is instead copied into this ring, and the
+   console thread writes it to the serial port, whose interrupt
+   handler sends it on, and to the vga display.  Printing then
+   costs a memcpy() unless the ring is full.
+
+   Interrupt handlers cannot wait for room in the ring, and a
+   panicking kernel cannot count on the console thread running
+   again, so both write synchronously instead, after flushing
+   what is already in the ring so that output stays in order. */
+#define RING_SIZE 4096                  /* Must be a power of 2. */
+static uint8_t ring[RING_SIZE];
+static unsigned ring_head;              /* Total bytes appended. */
+static unsigned ring_tail;              /* Total bytes written out. */
+static bool use_ring;                   /* Output through the ring? */
+
+/* Wakeups between writers and the console thread.  The ring
+   indexes and these flags are protected by disabling
+   interrupts. */
+static struct semaphore ring_data;      /* Ring no longer empty. */
+static struct semaphore ring_space;     /* Ring no longer full. */
+static bool drainer_waiting;            /* Console thread waits on data? */
+static bool writer_waiting;             /* Writer waits on space? */
+
 /* Enable console locking. */
 void
 console_init (void) 
@@ -67,13 +103,39 @@ console_init (void)
   use_console_lock = true;
 }
 
+/* Starts sending console output through the output ring, to be
+   written out by a separate thread.  Must be called after
+   threads and interrupts are running. */
+void
+console_init_queue (void) 
+{
+  sema_init (&ring_data, 0);
+  sema_init (&ring_space, 0);
+  thread_create ("console", PRI_DEFAULT, console_thread, NULL);
+  use_ring = true;
+}
+
 /* Notifies the console that a kernel panic is underway,
    which warns it to avoid trying to take the console lock from
-   now on. */
+   now on.  Output already in the ring is written out, and later
+   output bypasses the ring. */
 void
 console_panic (void) 
 {
   use_console_lock = false;
+  if (use_ring)
+    {
+      use_ring = false;
+      ring_flush ();
+    }
+}
+
+/* Writes out everything in the output ring before returning.
+   Call before shutting down, so that no output is lost. */
+void
+console_flush (void) 
+{
+  ring_flush ();
 }
 
 /* Prints console statistics. */
@@ -153,8 +215,7 @@ void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  write_have_lock ((const uint8_t *) buffer, n);
   release_console ();
 }
 
@@ -183,9 +244,152 @@ vprintf_helper (char c, void *char_cnt_)
    appropriate. */
 static void
 putchar_have_lock (uint8_t c) 
+{
+  write_have_lock (&c, 1);
+}
+
+/* Writes the N characters in BUFFER to the vga display and
+   serial port, through the output ring if it is in use.
+   The caller has already acquired the console lock if
+   appropriate. */
+static void
+write_have_lock (const uint8_t *buffer, size_t n) 
 {
   ASSERT (console_locked_by_current_thread ());
-  write_cnt++;
+  write_cnt += n;
+  if (use_ring && !intr_context ())
+    ring_append (buffer, n);
+  else
+    {
+      if (use_ring)
+        ring_flush ();
+      while (n-- > 0)
+        putchar_sync (*buffer++);
+    }
+}
+
+/* Copies the N bytes in BUFFER into the output ring.  Waits for
+   the console thread to make room if the ring fills up, unless
+   interrupts are off, in which case the ring is flushed
+   synchronously instead. */
+static void
+ring_append (const uint8_t *buffer, size_t n) 
+{
+  while (n > 0)
+    {
+      enum intr_level old_level = intr_disable ();
+      size_t ofs, chunk;
+
+      while (ring_head - ring_tail == RING_SIZE)
+        {
+          if (old_level == INTR_OFF)
+            ring_flush ();
+          else
+            {
+              writer_waiting = true;
+              sema_down (&ring_space);
+            }
+        }
+
+      /* Copy as much as fits before the ring's free space ends
+         or wraps around.  The console thread only reads bytes
+         before RING_HEAD, so the copy itself needs no
+         protection. */
+      ofs = ring_head % RING_SIZE;
+      chunk = RING_SIZE - (ring_head - ring_tail);
+      if (chunk > RING_SIZE - ofs)
+        chunk = RING_SIZE - ofs;
+      if (chunk > n)
+        chunk = n;
+      intr_set_level (old_level);
+
+      memcpy (ring + ofs, buffer, chunk);
+      buffer += chunk;
+      n -= chunk;
+
+      old_level = intr_disable ();
+      ring_head += chunk;
+      if (drainer_waiting)
+        {
+          drainer_waiting = false;
+          sema_up (&ring_data);
+        }
+      intr_set_level (old_level);
+    }
+}
+
+/* Takes the oldest byte out of the output ring and writes it
+   out.  Returns false if the ring was empty.
+
+   Interrupts stay off until the byte has been handed on, so that
+   no other thread or interrupt handler can take out and write a
+   later byte, or write output of its own synchronously, in
+   between.  That is brief as long as the serial port's transmit
+   queue has room, which the console thread waits for before
+   calling; only synchronous flushes, which run with interrupts
+   off anyway, may have to poll the port. */
+static bool
+ring_drain_one (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  uint8_t c;
+
+  if (ring_head == ring_tail)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  c = ring[ring_tail++ % RING_SIZE];
+
+  /* Let a waiting writer go once half of the ring is free,
+     rather than waking it for every byte. */
+  if (writer_waiting && ring_head - ring_tail <= RING_SIZE / 2)
+    {
+      writer_waiting = false;
+      sema_up (&ring_space);
+    }
+  putchar_sync (c);
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Writes out everything in the output ring, without waiting
+   for the console thread. */
+static void
+ring_flush (void) 
+{
+  while (ring_drain_one ())
+    continue;
+}
+
+/* Console thread.  Writes the contents of the output ring to
+   the serial port and vga display as it fills. */
+static void
+console_thread (void *aux UNUSED) 
+{
+  for (;;)
+    {
+      enum intr_level old_level = intr_disable ();
+      while (ring_head == ring_tail)
+        {
+          drainer_waiting = true;
+          sema_down (&ring_data);
+        }
+
+      /* Sleep, instead of polling the port with interrupts off,
+         until the serial port can queue another byte for its
+         interrupt handler to send. */
+      serial_wait_room ();
+      ring_drain_one ();
+      intr_set_level (old_level);
+    }
+}
+
+/* Writes C to the vga display and serial port, waiting for the
+   serial port if its queue is full. */
+static void
+putchar_sync (uint8_t c) 
+{
   serial_putc (c);
   vga_putc (c);
 }
@@ -28,7 +28,21 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_PREAD,                  /* Read from a file at a given position. */
+    SYS_PWRITE,                 /* Write to a file at a given position. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV,                 /* Write to a file from several buffers. */
+    SYS_RING_ENTER,             /* Run the syscalls queued on a ring. */
+    SYS_COPY_FILE_RANGE,        /* Copy data from one file to another. */
+    SYS_SPAWN,                  /* Start a process without waiting. */
+    SYS_SPAWN_MANY,             /* Start several processes at once. */
+    SYS_FORK,                   /* Duplicate the current process. */
+    SYS_WAITPID,                /* Wait for any or a given child. */
+    SYS_MADVISE,                /* Describe use of a range of memory. */
+    SYS_FADVISE                 /* Describe use of a range of a file. */
   };
 
 #endif /* lib/syscall-nr.h */
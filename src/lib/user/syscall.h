@@ -2,12 +2,19 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <advice.h>
 #include <debug.h>
+#include <iovec.h>
 
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) -1)
 
+/* waitpid() option: return 0 at once if no child has exited. */
+#define WNOHANG 1
+
 /* Map region identifier. */
 typedef int mapid_t;
 #define MAP_FAILED ((mapid_t) -1)
@@ -15,6 +22,42 @@ typedef int mapid_t;
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
+/* Number of entries in each queue of a struct ring.
+   Must be a power of 2. */
+#define RING_SIZE 64
+
+/* A syscall queued on a ring's submission queue. */
+struct ring_sqe
+  {
+    int number;                 /* SYS_* number from syscall-nr.h. */
+    uint32_t args[4];           /* Arguments, as they would be pushed. */
+    uint32_t user_data;         /* Copied to the completion untouched. */
+  };
+
+/* The result of a queued syscall, on a ring's completion queue. */
+struct ring_cqe
+  {
+    uint32_t user_data;         /* From the submission. */
+    int result;                 /* Syscall's return value. */
+  };
+
+/* A submission queue and a completion queue, kept in user memory
+   and read and written directly by the kernel in ring_enter().
+   All four indexes run freely and are reduced modulo RING_SIZE
+   to find an entry.  The process fills sq[sq_tail] and advances
+   sq_tail, and consumes cq[cq_head] and advances cq_head; the
+   kernel advances sq_head and cq_tail.  The whole structure fits
+   in one page. */
+struct ring
+  {
+    unsigned sq_head;           /* Next submission for the kernel. */
+    unsigned sq_tail;           /* Next free submission slot. */
+    unsigned cq_head;           /* Next completion for the process. */
+    unsigned cq_tail;           /* Next free completion slot. */
+    struct ring_sqe sq[RING_SIZE];
+    struct ring_cqe cq[RING_SIZE];
+  };
+
 /* Typical return values from main() and arguments to exit(). */
 #define EXIT_SUCCESS 0          /* Successful execution. */
 #define EXIT_FAILURE 1          /* Unsuccessful execution. */
@@ -45,4 +88,18 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int pread (int fd, void *buffer, unsigned length, unsigned position);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned position);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int ring_enter (struct ring *);
+int copy_file_range (int fd_in, int fd_out, unsigned length);
+pid_t spawn (const char *file);
+int spawn_many (const char **files, pid_t *pids, unsigned cnt);
+pid_t fork (void);
+pid_t waitpid (pid_t, int *status, int options);
+int madvise (void *addr, unsigned length, int advice);
+int fadvise (int fd, unsigned offset, unsigned length, int advice);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,47 @@
+/* Child process for syn-own test.
+   Writes a pattern of its own into its own file and reads it
+   back, PASSES times over.  Other processes are doing the same
+   with other files at the same time. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/filesys/base/syn-own.h"
+
+const char *test_name = "child-syn-own";
+
+static char buf[FILE_SIZE];
+static char check[FILE_SIZE];
+
+int
+main (int argc, char *argv[])
+{
+  char name[16];
+  int child_idx;
+  int fd;
+  int pass;
+
+  quiet = true;
+
+  CHECK (argc == 2, "argc must be 2, actually %d", argc);
+  child_idx = atoi (argv[1]);
+  snprintf (name, sizeof name, "own%d", child_idx);
+
+  CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+  for (pass = 0; pass < PASSES; pass++) 
+    {
+      memset (buf, child_idx * PASSES + pass, sizeof buf);
+      seek (fd, 0);
+      CHECK (write (fd, buf, sizeof buf) == (int) sizeof buf,
+             "write \"%s\"", name);
+      seek (fd, 0);
+      CHECK (read (fd, check, sizeof check) == (int) sizeof check,
+             "read \"%s\"", name);
+      compare_bytes (check, buf, sizeof buf, 0, name);
+    }
+  close (fd);
+
+  return child_idx;
+}
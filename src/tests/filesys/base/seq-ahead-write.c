@@ -0,0 +1,55 @@
+/* Reads a file sequentially, so that the sectors after each read
+   are prefetched, while writing through a second descriptor to
+   the part of the file just ahead of the reader.  The reader
+   must see the new data, not what was read ahead. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 8192
+#define CHUNK_SIZE 512
+
+static char buf[FILE_SIZE];
+static char patch[CHUNK_SIZE];
+
+void
+test_main (void) 
+{
+  char chunk[CHUNK_SIZE];
+  int rd_fd, wr_fd;
+  size_t ofs;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("data", sizeof buf), "create \"data\"");
+  CHECK ((wr_fd = open ("data")) > 1, "open \"data\" for writing");
+  CHECK (write (wr_fd, buf, sizeof buf) == (int) sizeof buf,
+         "write \"data\"");
+  CHECK ((rd_fd = open ("data")) > 1, "open \"data\" for reading");
+
+  msg ("read \"data\", writing ahead of the reader");
+  memset (patch, 'x', sizeof patch);
+  for (ofs = 0; ofs < sizeof buf; ofs += CHUNK_SIZE) 
+    {
+      if (read (rd_fd, chunk, CHUNK_SIZE) != CHUNK_SIZE)
+        fail ("read %d bytes at offset %zu failed", CHUNK_SIZE, ofs);
+      compare_bytes (chunk, buf + ofs, CHUNK_SIZE, ofs, "data");
+
+      /* Overwrite the chunk after the next one. */
+      if (ofs + 3 * CHUNK_SIZE <= sizeof buf) 
+        {
+          seek (wr_fd, ofs + 2 * CHUNK_SIZE);
+          if (write (wr_fd, patch, CHUNK_SIZE) != CHUNK_SIZE)
+            fail ("write %d bytes at offset %zu failed",
+                  CHUNK_SIZE, ofs + 2 * CHUNK_SIZE);
+          memcpy (buf + ofs + 2 * CHUNK_SIZE, patch, CHUNK_SIZE);
+        }
+    }
+
+  msg ("close \"data\"");
+  close (rd_fd);
+  close (wr_fd);
+  check_file ("data", buf, sizeof buf);
+}
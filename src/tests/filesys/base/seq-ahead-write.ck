@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(seq-ahead-write) begin
+(seq-ahead-write) create "data"
+(seq-ahead-write) open "data" for writing
+(seq-ahead-write) write "data"
+(seq-ahead-write) open "data" for reading
+(seq-ahead-write) read "data", writing ahead of the reader
+(seq-ahead-write) close "data"
+(seq-ahead-write) open "data" for verification
+(seq-ahead-write) verified contents of "data"
+(seq-ahead-write) close "data"
+(seq-ahead-write) end
+EOF
+pass;
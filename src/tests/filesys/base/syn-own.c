@@ -0,0 +1,28 @@
+/* Spawns 4 child processes, each of which writes and reads back
+   a file of its own over and over, all at the same time.  None
+   of them should have to wait for the others' disk I/O, and all
+   of them should see their own data. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/filesys/base/syn-own.h"
+
+void
+test_main (void) 
+{
+  pid_t children[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "own%d", i);
+      CHECK (create (name, FILE_SIZE), "create \"%s\"", name);
+    }
+
+  exec_children ("child-syn-own", children, CHILD_CNT);
+  wait_children (children, CHILD_CNT);
+}
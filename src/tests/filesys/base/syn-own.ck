@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(syn-own) begin
+(syn-own) create "own0"
+(syn-own) create "own1"
+(syn-own) create "own2"
+(syn-own) create "own3"
+(syn-own) exec child 1 of 4: "child-syn-own 0"
+(syn-own) exec child 2 of 4: "child-syn-own 1"
+(syn-own) exec child 3 of 4: "child-syn-own 2"
+(syn-own) exec child 4 of 4: "child-syn-own 3"
+(syn-own) wait for child 1 of 4 returned 0 (expected 0)
+(syn-own) wait for child 2 of 4 returned 1 (expected 1)
+(syn-own) wait for child 3 of 4 returned 2 (expected 2)
+(syn-own) wait for child 4 of 4 returned 3 (expected 3)
+(syn-own) end
+EOF
+pass;
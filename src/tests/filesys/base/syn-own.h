@@ -0,0 +1,8 @@
+#ifndef TESTS_FILESYS_BASE_SYN_OWN_H
+#define TESTS_FILESYS_BASE_SYN_OWN_H
+
+#define CHILD_CNT 4
+#define FILE_SIZE 8192
+#define PASSES 8
+
+#endif /* tests/filesys/base/syn-own.h */
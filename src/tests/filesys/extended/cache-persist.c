@@ -0,0 +1,25 @@
+/* Writes a 20,000-byte file of fixed size 97 bytes at a time,
+   so that most of its sectors sit dirty in the buffer cache,
+   and checks it.  The persistence check then makes sure that
+   all of it reached the disk at shutdown. */
+
+#include "tests/filesys/seq-test.h"
+#include "tests/main.h"
+
+#define TEST_SIZE 20000
+
+static char buf[TEST_SIZE];
+
+static size_t
+return_block_size (void) 
+{
+  return 97;
+}
+
+void
+test_main (void) 
+{
+  seq_test ("cached",
+            buf, sizeof buf, sizeof buf,
+            return_block_size, NULL);
+}
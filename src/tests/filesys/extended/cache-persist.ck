@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cache-persist) begin
+(cache-persist) create "cached"
+(cache-persist) open "cached"
+(cache-persist) writing "cached"
+(cache-persist) close "cached"
+(cache-persist) open "cached" for verification
+(cache-persist) verified contents of "cached"
+(cache-persist) close "cached"
+(cache-persist) end
+EOF
+pass;
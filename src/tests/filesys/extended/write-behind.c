@@ -0,0 +1,49 @@
+/* Overwrites the same 4,096-byte file many times over, reading
+   each version back, so that the write-behind thread's passes
+   over the cache overlap the writes.  Each version must read
+   back intact, and the persistence check makes sure that the
+   last one is what reached the disk. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 4096
+#define PASSES 200
+
+static char buf[FILE_SIZE];
+static char check[FILE_SIZE];
+
+void
+test_main (void) 
+{
+  int fd;
+  int pass;
+
+  CHECK (create ("behind", sizeof buf), "create \"behind\"");
+  CHECK ((fd = open ("behind")) > 1, "open \"behind\"");
+
+  msg ("overwrite \"behind\" %d times", PASSES);
+  for (pass = 0; pass < PASSES; pass++) 
+    {
+      /* The last version is the one the persistence check
+         expects. */
+      if (pass < PASSES - 1)
+        memset (buf, pass, sizeof buf);
+      else
+        random_bytes (buf, sizeof buf);
+
+      seek (fd, 0);
+      if (write (fd, buf, sizeof buf) != (int) sizeof buf)
+        fail ("write pass %d failed", pass);
+      seek (fd, 0);
+      if (read (fd, check, sizeof check) != (int) sizeof check)
+        fail ("read pass %d failed", pass);
+      compare_bytes (check, buf, sizeof buf, 0, "behind");
+    }
+
+  msg ("close \"behind\"");
+  close (fd);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(write-behind) begin
+(write-behind) create "behind"
+(write-behind) open "behind"
+(write-behind) overwrite "behind" 200 times
+(write-behind) close "behind"
+(write-behind) end
+EOF
+pass;
@@ -0,0 +1,10 @@
+/* Child process run by wait-many.
+   Exits with the number given as its argument. */
+
+#include <stdlib.h>
+
+int
+main (int argc, char *argv[]) 
+{
+  return argc == 2 ? atoi (argv[1]) : -1;
+}
@@ -0,0 +1,37 @@
+/* Opens a file twice and checks that copy_file_range() refuses
+   to copy between overlapping ranges of it, but copies between
+   ranges that do not overlap. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char expected[sizeof sample - 1];
+  int in_fd, out_fd, byte_cnt;
+
+  CHECK ((in_fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((out_fd = open ("sample.txt")) > 1, "open \"sample.txt\" again");
+
+  seek (out_fd, 10);
+  byte_cnt = copy_file_range (in_fd, out_fd, 100);
+  if (byte_cnt != -1)
+    fail ("copy_file_range() returned %d for overlapping ranges",
+          byte_cnt);
+  if (tell (in_fd) != 0 || tell (out_fd) != 10)
+    fail ("file positions moved by failed copy");
+  check_file ("sample.txt", sample, sizeof sample - 1);
+
+  seek (out_fd, 100);
+  byte_cnt = copy_file_range (in_fd, out_fd, 100);
+  if (byte_cnt != 100)
+    fail ("copy_file_range() returned %d instead of 100", byte_cnt);
+
+  memcpy (expected, sample, sizeof expected);
+  memcpy (expected + 100, sample, 100);
+  check_file ("sample.txt", expected, sizeof expected);
+}
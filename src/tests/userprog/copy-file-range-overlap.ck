@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(copy-file-range-overlap) begin
+(copy-file-range-overlap) open "sample.txt"
+(copy-file-range-overlap) open "sample.txt" again
+(copy-file-range-overlap) open "sample.txt" for verification
+(copy-file-range-overlap) verified contents of "sample.txt"
+(copy-file-range-overlap) close "sample.txt"
+(copy-file-range-overlap) open "sample.txt" for verification
+(copy-file-range-overlap) verified contents of "sample.txt"
+(copy-file-range-overlap) close "sample.txt"
+(copy-file-range-overlap) end
+copy-file-range-overlap: exit(0)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Copies a file into a new file with copy_file_range(), in two
+   pieces, and checks the copy. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int in_fd, out_fd, byte_cnt;
+
+  CHECK ((in_fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (create ("test.txt", sizeof sample - 1), "create \"test.txt\"");
+  CHECK ((out_fd = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  byte_cnt = copy_file_range (in_fd, out_fd, 100);
+  if (byte_cnt != 100)
+    fail ("copy_file_range() returned %d instead of 100", byte_cnt);
+  byte_cnt = copy_file_range (in_fd, out_fd, 1000);
+  if (byte_cnt != (int) (sizeof sample - 1 - 100))
+    fail ("copy_file_range() returned %d instead of %zu",
+          byte_cnt, sizeof sample - 1 - 100);
+  if (tell (in_fd) != sizeof sample - 1 || tell (out_fd) != sizeof sample - 1)
+    fail ("file positions not advanced");
+
+  check_file ("test.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,17 @@
+/* Passes exec() a command line longer than a page, which must
+   fail without killing the process. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char cmd_line[5000];
+  memset (cmd_line, 'x', sizeof cmd_line);
+  cmd_line[sizeof cmd_line - 1] = '\0';
+
+  msg ("exec(\"x...\"): %d", exec (cmd_line));
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-long) begin
+(exec-long) exec("x..."): -1
+(exec-long) end
+exec-long: exit(0)
+EOF
+pass;
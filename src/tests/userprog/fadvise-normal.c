@@ -0,0 +1,46 @@
+/* Gives each kind of advice about a file with fadvise() and
+   checks that reads still return the right data, and that bad
+   advice and bad descriptors are refused. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[sizeof sample];
+  size_t half = (sizeof sample - 1) / 2;
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  if (fadvise (handle, 0, 0, ADV_SEQUENTIAL) != 0)
+    fail ("fadvise(ADV_SEQUENTIAL) failed");
+  byte_cnt = read (handle, buf, half);
+  byte_cnt += read (handle, buf + half, sizeof sample - 1 - half);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("read() returned %d bytes instead of %zu",
+          byte_cnt, sizeof sample - 1);
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "sample.txt");
+
+  if (fadvise (handle, 0, 0, ADV_RANDOM) != 0)
+    fail ("fadvise(ADV_RANDOM) failed");
+  if (fadvise (handle, half, 0, ADV_WILLNEED) != 0)
+    fail ("fadvise(ADV_WILLNEED) failed");
+  if (fadvise (handle, 0, half, ADV_DONTNEED) != 0)
+    fail ("fadvise(ADV_DONTNEED) failed");
+  byte_cnt = pread (handle, buf, sizeof sample - 1, 0);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("pread() returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "sample.txt");
+
+  if (fadvise (handle, 0, 0, ADV_DONTNEED + 1) != -1)
+    fail ("fadvise() with bad advice did not fail");
+  if (fadvise (STDOUT_FILENO, 0, 0, ADV_NORMAL) != -1)
+    fail ("fadvise() on the console did not fail");
+  if (fadvise (handle + 1, 0, 0, ADV_NORMAL) != -1)
+    fail ("fadvise() on a closed descriptor did not fail");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fadvise-normal) begin
+(fadvise-normal) open "sample.txt"
+(fadvise-normal) end
+fadvise-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,25 @@
+/* Forks a child that changes a global variable, then checks
+   that the parent's copy of the variable did not change. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int value = 1;
+
+void
+test_main (void) 
+{
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      if (value != 1)
+        exit (1);
+      value = 2;
+      exit (42);
+    }
+
+  CHECK (pid != PID_ERROR, "fork");
+  CHECK (wait (pid) == 42, "wait(fork())");
+  CHECK (value == 1, "parent's value unchanged");
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(fork-normal) begin
+fork-normal: exit(42)
+(fork-normal) fork
+(fork-normal) wait(fork())
+(fork-normal) parent's value unchanged
+(fork-normal) end
+fork-normal: exit(0)
+EOF
+(fork-normal) begin
+(fork-normal) fork
+fork-normal: exit(42)
+(fork-normal) wait(fork())
+(fork-normal) parent's value unchanged
+(fork-normal) end
+fork-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Opens the same file more times than fit in a process's first
+   descriptor table, checks that every descriptor is distinct and
+   reads the file from its own position, then closes one in the
+   middle and checks that the next open() reuses it. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FD_CNT 40
+
+void
+test_main (void) 
+{
+  int fds[FD_CNT];
+  int i, j, fd;
+
+  msg ("open \"sample.txt\" %d times", FD_CNT);
+  for (i = 0; i < FD_CNT; i++) 
+    {
+      fds[i] = open ("sample.txt");
+      if (fds[i] < 2)
+        fail ("open #%d returned %d", i, fds[i]);
+      for (j = 0; j < i; j++)
+        if (fds[j] == fds[i])
+          fail ("opens #%d and #%d both returned %d", j, i, fds[i]);
+    }
+
+  msg ("read one byte at a different offset from each");
+  for (i = 0; i < FD_CNT; i++) 
+    {
+      char c;
+
+      seek (fds[i], i);
+      if (read (fds[i], &c, 1) != 1 || c != sample[i])
+        fail ("read from fd %d at offset %d failed", fds[i], i);
+    }
+
+  close (fds[FD_CNT / 2]);
+  CHECK ((fd = open ("sample.txt")) == fds[FD_CNT / 2],
+         "open \"sample.txt\" reuses closed fd");
+}
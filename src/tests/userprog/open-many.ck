@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-many) begin
+(open-many) open "sample.txt" 40 times
+(open-many) read one byte at a different offset from each
+(open-many) open "sample.txt" reuses closed fd
+(open-many) end
+open-many: exit(0)
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Reads the second half of a file, then the first half, with
+   pread(), and checks that the file position is not moved. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[sizeof sample];
+  size_t half = (sizeof sample - 1) / 2;
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  byte_cnt = pread (handle, buf + half, sizeof sample - 1 - half, half);
+  if (byte_cnt != (int) (sizeof sample - 1 - half))
+    fail ("pread() returned %d instead of %zu",
+          byte_cnt, sizeof sample - 1 - half);
+  byte_cnt = pread (handle, buf, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pread() returned %d instead of %zu", byte_cnt, half);
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "sample.txt");
+
+  byte_cnt = pread (handle, buf, sizeof buf, sizeof sample);
+  if (byte_cnt != 0)
+    fail ("pread() past end of file returned %d instead of 0", byte_cnt);
+
+  if (tell (handle) != 0)
+    fail ("file position moved to %u", tell (handle));
+}
@@ -0,0 +1,29 @@
+/* Writes a file back to front with pwrite(), then checks that
+   the file position was not moved and the contents are right. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t half = (sizeof sample - 1) / 2;
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", sizeof sample - 1), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  byte_cnt = pwrite (handle, sample + half, sizeof sample - 1 - half, half);
+  if (byte_cnt != (int) (sizeof sample - 1 - half))
+    fail ("pwrite() returned %d instead of %zu",
+          byte_cnt, sizeof sample - 1 - half);
+  byte_cnt = pwrite (handle, sample, half, 0);
+  if (byte_cnt != (int) half)
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, half);
+
+  if (tell (handle) != 0)
+    fail ("file position moved to %u", tell (handle));
+  check_file_handle (handle, "test.txt", sample, sizeof sample - 1);
+}
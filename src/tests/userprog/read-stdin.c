@@ -0,0 +1,18 @@
+/* Reads from the keyboard without typing anything.  A zero-byte
+   read must return 0 at once, and a read into kernel memory must
+   kill the process rather than wait for a key. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf;
+
+  CHECK (read (STDIN_FILENO, &buf, 0) == 0, "read 0 bytes from stdin");
+  read (STDIN_FILENO, (char *) 0xc0100000, 16);
+  fail ("should have exited with -1");
+}
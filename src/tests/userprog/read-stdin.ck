@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_USER_FAULTS => 1, [<<'EOF']);
+(read-stdin) begin
+(read-stdin) read 0 bytes from stdin
+read-stdin: exit(-1)
+EOF
+pass;
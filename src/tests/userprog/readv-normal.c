@@ -0,0 +1,33 @@
+/* Reads a file into three buffers with a single readv(). */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char head[16], middle[64], tail[sizeof sample];
+  struct iovec iov[3];
+  size_t tail_len = sizeof sample - 1 - sizeof head - sizeof middle;
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof head;
+  iov[1].iov_base = middle;
+  iov[1].iov_len = sizeof middle;
+  iov[2].iov_base = tail;
+  iov[2].iov_len = sizeof tail;
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("readv() returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+
+  compare_bytes (head, sample, sizeof head, 0, "sample.txt");
+  compare_bytes (middle, sample + sizeof head, sizeof middle, sizeof head,
+                 "sample.txt");
+  compare_bytes (tail, sample + sizeof head + sizeof middle, tail_len,
+                 sizeof head + sizeof middle, "sample.txt");
+}
@@ -0,0 +1,65 @@
+/* Queues an open, a read and a close on a ring, runs them with a
+   single ring_enter(), and checks each completion. */
+
+#include <string.h>
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ring ring;
+
+/* Queues syscall NUMBER with arguments ARG0...ARG2. */
+static void
+queue (int number, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+  struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_SIZE];
+  sqe->number = number;
+  sqe->args[0] = arg0;
+  sqe->args[1] = arg1;
+  sqe->args[2] = arg2;
+  sqe->user_data = ring.sq_tail;
+  ring.sq_tail++;
+}
+
+/* Returns the result of the next completion, which must be for
+   submission USER_DATA. */
+static int
+reap (uint32_t user_data)
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("completion queue empty");
+  cqe = &ring.cq[ring.cq_head++ % RING_SIZE];
+  if (cqe->user_data != user_data)
+    fail ("completion for %u instead of %u", cqe->user_data, user_data);
+  return cqe->result;
+}
+
+void
+test_main (void) 
+{
+  char buf[sizeof sample];
+  int handle, byte_cnt;
+
+  queue (SYS_OPEN, (uint32_t) "sample.txt", 0, 0);
+  CHECK (ring_enter (&ring) == 1, "ring_enter open");
+  handle = reap (0);
+  if (handle < 2)
+    fail ("open returned %d", handle);
+
+  queue (SYS_READ, handle, (uint32_t) buf, sizeof sample - 1);
+  queue (SYS_CLOSE, handle, 0, 0);
+  queue (SYS_RING_ENTER, (uint32_t) &ring, 0, 0);
+  CHECK (ring_enter (&ring) == 3, "ring_enter read, close");
+
+  byte_cnt = reap (1);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("read returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+  compare_bytes (buf, sample, sizeof sample - 1, 0, "sample.txt");
+  reap (2);
+  if (reap (3) != -1)
+    fail ("nested ring_enter did not fail");
+}
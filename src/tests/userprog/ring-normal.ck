@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-normal) begin
+(ring-normal) ring_enter open
+(ring-normal) ring_enter read, close
+(ring-normal) end
+ring-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,17 @@
+/* Invokes a system call with a number far beyond any that
+   exists.  The process must be terminated with -1 exit code. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Not a system call number, now or after any plausible
+   addition to lib/syscall-nr.h. */
+#define BAD_SYSCALL 0x10000
+
+void
+test_main (void) 
+{
+  asm volatile ("pushl %0; int $0x30; addl $4, %%esp"
+                : : "i" (BAD_SYSCALL) : "memory");
+  fail ("should have called exit(-1)");
+}
@@ -0,0 +1,19 @@
+/* Starts two children with one spawn_many() call and waits for
+   both of them. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  const char *cmd_lines[] = {"child-simple", "child-simple"};
+  pid_t pids[2];
+  int i;
+
+  CHECK (spawn_many (cmd_lines, pids, 2) == 2, "spawn_many");
+  for (i = 0; i < 2; i++)
+    if (wait (pids[i]) != 81)
+      fail ("wrong exit status from child %d", i);
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(spawn-many) begin
+(spawn-many) spawn_many
+(child-simple) run
+child-simple: exit(81)
+(child-simple) run
+child-simple: exit(81)
+(spawn-many) end
+spawn-many: exit(0)
+EOF
+(spawn-many) begin
+(spawn-many) spawn_many
+(child-simple) run
+(child-simple) run
+child-simple: exit(81)
+child-simple: exit(81)
+(spawn-many) end
+spawn-many: exit(0)
+EOF
+pass;
@@ -0,0 +1,17 @@
+/* Spawns a program that does not exist.  spawn() itself
+   succeeds, because it does not wait for the load, and the
+   failure shows up as an exit status of -1 from wait(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t pid;
+
+  CHECK ((pid = spawn ("no-such-file")) != PID_ERROR,
+         "spawn(\"no-such-file\")");
+  CHECK (wait (pid) == -1, "wait(spawn(\"no-such-file\"))");
+}
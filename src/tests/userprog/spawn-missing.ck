@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(spawn-missing) begin
+(spawn-missing) spawn("no-such-file")
+load: no-such-file: open failed
+(spawn-missing) wait(spawn("no-such-file"))
+(spawn-missing) end
+spawn-missing: exit(0)
+EOF
+pass;
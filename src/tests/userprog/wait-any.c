@@ -0,0 +1,35 @@
+/* Starts two children and reaps them with waitpid(-1), which
+   must return each child's pid exactly once, then -1 once none
+   is left. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t pids[2];
+  bool reaped[2] = {false, false};
+  int i;
+
+  for (i = 0; i < 2; i++)
+    if ((pids[i] = exec ("child-simple")) == PID_ERROR)
+      fail ("exec failed");
+
+  for (i = 0; i < 2; i++)
+    {
+      int status, j;
+      pid_t pid = waitpid (-1, &status, 0);
+
+      for (j = 0; j < 2; j++)
+        if (pid == pids[j] && !reaped[j])
+          break;
+      if (j == 2)
+        fail ("waitpid returned unexpected pid %d", pid);
+      if (status != 81)
+        fail ("wrong exit status %d from child %d", status, j);
+      reaped[j] = true;
+    }
+  CHECK (waitpid (-1, NULL, 0) == -1, "waitpid with no children left");
+}
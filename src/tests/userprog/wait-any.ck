@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(wait-any) begin
+(child-simple) run
+child-simple: exit(81)
+(child-simple) run
+child-simple: exit(81)
+(wait-any) waitpid with no children left
+(wait-any) end
+wait-any: exit(0)
+EOF
+(wait-any) begin
+(child-simple) run
+(child-simple) run
+child-simple: exit(81)
+child-simple: exit(81)
+(wait-any) waitpid with no children left
+(wait-any) end
+wait-any: exit(0)
+EOF
+pass;
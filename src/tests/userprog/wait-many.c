@@ -0,0 +1,28 @@
+/* Starts many children at once, then waits for them newest first
+   and checks that each can be waited for only once. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 24
+
+void
+test_main (void) 
+{
+  pid_t pids[CHILD_CNT];
+  int i;
+
+  exec_children ("child-quiet", pids, CHILD_CNT);
+  for (i = CHILD_CNT - 1; i >= 0; i--) 
+    {
+      int status = wait (pids[i]);
+      CHECK (status == i, "wait for child %d of %d returned %d (expected %d)",
+             i + 1, CHILD_CNT, status, i);
+    }
+  for (i = 0; i < CHILD_CNT; i++)
+    if (wait (pids[i]) != -1)
+      fail ("second wait for child %d of %d did not return -1",
+            i + 1, CHILD_CNT);
+  msg ("second wait for each child returned -1");
+}
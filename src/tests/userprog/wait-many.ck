@@ -0,0 +1,58 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(wait-many) begin
+(wait-many) exec child 1 of 24: "child-quiet 0"
+(wait-many) exec child 2 of 24: "child-quiet 1"
+(wait-many) exec child 3 of 24: "child-quiet 2"
+(wait-many) exec child 4 of 24: "child-quiet 3"
+(wait-many) exec child 5 of 24: "child-quiet 4"
+(wait-many) exec child 6 of 24: "child-quiet 5"
+(wait-many) exec child 7 of 24: "child-quiet 6"
+(wait-many) exec child 8 of 24: "child-quiet 7"
+(wait-many) exec child 9 of 24: "child-quiet 8"
+(wait-many) exec child 10 of 24: "child-quiet 9"
+(wait-many) exec child 11 of 24: "child-quiet 10"
+(wait-many) exec child 12 of 24: "child-quiet 11"
+(wait-many) exec child 13 of 24: "child-quiet 12"
+(wait-many) exec child 14 of 24: "child-quiet 13"
+(wait-many) exec child 15 of 24: "child-quiet 14"
+(wait-many) exec child 16 of 24: "child-quiet 15"
+(wait-many) exec child 17 of 24: "child-quiet 16"
+(wait-many) exec child 18 of 24: "child-quiet 17"
+(wait-many) exec child 19 of 24: "child-quiet 18"
+(wait-many) exec child 20 of 24: "child-quiet 19"
+(wait-many) exec child 21 of 24: "child-quiet 20"
+(wait-many) exec child 22 of 24: "child-quiet 21"
+(wait-many) exec child 23 of 24: "child-quiet 22"
+(wait-many) exec child 24 of 24: "child-quiet 23"
+(wait-many) wait for child 24 of 24 returned 23 (expected 23)
+(wait-many) wait for child 23 of 24 returned 22 (expected 22)
+(wait-many) wait for child 22 of 24 returned 21 (expected 21)
+(wait-many) wait for child 21 of 24 returned 20 (expected 20)
+(wait-many) wait for child 20 of 24 returned 19 (expected 19)
+(wait-many) wait for child 19 of 24 returned 18 (expected 18)
+(wait-many) wait for child 18 of 24 returned 17 (expected 17)
+(wait-many) wait for child 17 of 24 returned 16 (expected 16)
+(wait-many) wait for child 16 of 24 returned 15 (expected 15)
+(wait-many) wait for child 15 of 24 returned 14 (expected 14)
+(wait-many) wait for child 14 of 24 returned 13 (expected 13)
+(wait-many) wait for child 13 of 24 returned 12 (expected 12)
+(wait-many) wait for child 12 of 24 returned 11 (expected 11)
+(wait-many) wait for child 11 of 24 returned 10 (expected 10)
+(wait-many) wait for child 10 of 24 returned 9 (expected 9)
+(wait-many) wait for child 9 of 24 returned 8 (expected 8)
+(wait-many) wait for child 8 of 24 returned 7 (expected 7)
+(wait-many) wait for child 7 of 24 returned 6 (expected 6)
+(wait-many) wait for child 6 of 24 returned 5 (expected 5)
+(wait-many) wait for child 5 of 24 returned 4 (expected 4)
+(wait-many) wait for child 4 of 24 returned 3 (expected 3)
+(wait-many) wait for child 3 of 24 returned 2 (expected 2)
+(wait-many) wait for child 2 of 24 returned 1 (expected 1)
+(wait-many) wait for child 1 of 24 returned 0 (expected 0)
+(wait-many) second wait for each child returned -1
+(wait-many) end
+EOF
+pass;
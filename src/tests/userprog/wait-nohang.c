@@ -0,0 +1,24 @@
+/* Polls a child with WNOHANG until it exits, then checks that
+   its status is reported and that it cannot be reaped twice. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child, pid;
+  int status;
+
+  if (waitpid (-1, &status, WNOHANG) != -1)
+    fail ("waitpid with no children did not return -1");
+  if ((child = exec ("child-simple")) == PID_ERROR)
+    fail ("exec failed");
+  while ((pid = waitpid (child, &status, WNOHANG)) == 0)
+    continue;
+  if (pid != child)
+    fail ("waitpid returned %d, expected %d", pid, child);
+  CHECK (status == 81, "exit status");
+  CHECK (waitpid (child, &status, WNOHANG) == -1, "waitpid twice");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(wait-nohang) begin
+(child-simple) run
+child-simple: exit(81)
+(wait-nohang) exit status
+(wait-nohang) waitpid twice
+(wait-nohang) end
+wait-nohang: exit(0)
+EOF
+pass;
@@ -0,0 +1,17 @@
+/* Passes waitpid() a status pointer into kernel memory.  The
+   kernel may only find out when it stores the child's status, so
+   the process must be killed then. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child;
+
+  CHECK ((child = exec ("child-simple")) != -1, "exec \"child-simple\"");
+  waitpid (child, (int *) 0xc0000000, 0);
+  fail ("should have exited with -1");
+}
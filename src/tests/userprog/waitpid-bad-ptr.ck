@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_USER_FAULTS => 1, [<<'EOF']);
+(waitpid-bad-ptr) begin
+(waitpid-bad-ptr) exec "child-simple"
+(child-simple) run
+child-simple: exit(81)
+waitpid-bad-ptr: exit(-1)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Writes 8 kB of numbered lines to the console in a single
+   write(), more than the console's output ring holds at once.
+   All of it must come out, in order. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define LINE_CNT 128
+#define LINE_LEN 64
+
+void
+test_main (void) 
+{
+  static char buf[LINE_CNT * LINE_LEN];
+  int i;
+
+  for (i = 0; i < LINE_CNT; i++) 
+    {
+      char *line = buf + i * LINE_LEN;
+      snprintf (line, 10, "line %03d ", i);
+      memset (line + 9, 'a' + i % 26, LINE_LEN - 10);
+      line[LINE_LEN - 1] = '\n';
+    }
+  if (write (STDOUT_FILENO, buf, sizeof buf) != (int) sizeof buf)
+    fail ("write to console was short");
+}
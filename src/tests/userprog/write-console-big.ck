@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($expected) = "(write-console-big) begin\n";
+$expected .= sprintf ("line %03d %s\n", $_, chr (ord ('a') + $_ % 26) x 54)
+  foreach 0...127;
+$expected .= "(write-console-big) end\nwrite-console-big: exit(0)\n";
+check_expected ([$expected]);
+pass;
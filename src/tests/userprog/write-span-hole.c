@@ -0,0 +1,21 @@
+/* Passes write() a buffer whose first byte is in the last page of
+   the bss segment and whose last byte is on the stack, so that
+   both ends are valid but the pages between them are not mapped.
+   Must kill the process. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/boundary.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char last = 'x';
+  char *start = (char *) get_bad_boundary () - 1;
+
+  *start = 'x';
+  write (STDOUT_FILENO, start, &last - start + 1);
+  fail ("should have exited with -1");
+}
@@ -0,0 +1,29 @@
+/* Writes a file from three buffers with a single writev(). */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct iovec iov[3];
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", sizeof sample - 1), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  iov[0].iov_base = sample;
+  iov[0].iov_len = 10;
+  iov[1].iov_base = sample + 10;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = sample + 10;
+  iov[2].iov_len = sizeof sample - 1 - 10;
+  byte_cnt = writev (handle, iov, 3);
+  if (byte_cnt != (int) (sizeof sample - 1))
+    fail ("writev() returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+
+  seek (handle, 0);
+  check_file_handle (handle, "test.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,42 @@
+/* Child process of page-share-text.
+   Checks a read-only table that spans many pages, starting at a
+   page chosen by its argument, so that copies running at once
+   fault the shared pages in different orders. */
+
+#include <stdlib.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-text";
+
+#define PAGE_INTS 1024
+#define PAGE_CNT 32
+
+/* Marks the first and last int of page N of TABLE. */
+#define P1(N) [(N) * PAGE_INTS] = (N) + 1, [(N) * PAGE_INTS + PAGE_INTS - 1] = ~(N)
+#define P4(N) P1 (N), P1 ((N) + 1), P1 ((N) + 2), P1 ((N) + 3)
+#define P16(N) P4 (N), P4 ((N) + 4), P4 ((N) + 8), P4 ((N) + 12)
+
+static const int table[PAGE_CNT * PAGE_INTS] = { P16 (0), P16 (16) };
+
+int
+main (int argc, char *argv[]) 
+{
+  int child_idx, pass, i;
+
+  quiet = true;
+  CHECK (argc == 2, "argc must be 2, actually %d", argc);
+  child_idx = atoi (argv[1]);
+
+  for (pass = 0; pass < 4; pass++)
+    for (i = 0; i < PAGE_CNT; i++) 
+      {
+        int n = (child_idx * 5 + i) % PAGE_CNT;
+        const int *page = table + n * PAGE_INTS;
+
+        if (page[0] != n + 1 || page[PAGE_INTS - 1] != ~n
+            || page[PAGE_INTS / 2] != 0)
+          fail ("page %d of table is corrupt", n);
+      }
+
+  return child_idx;
+}
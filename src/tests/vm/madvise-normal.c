@@ -0,0 +1,51 @@
+/* Writes to a file through a mapping, gives up the page with
+   madvise(ADV_DONTNEED), and checks that the data reached the
+   file and is still visible through the mapping.  Also checks
+   that the other kinds of advice are accepted and that bad
+   ranges and bad advice are refused. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+
+void
+test_main (void)
+{
+  int handle;
+  mapid_t map;
+  char buf[1024];
+
+  CHECK (create ("sample.txt", strlen (sample)), "create \"sample.txt\"");
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"sample.txt\"");
+  CHECK (madvise (ACTUAL, 4096, ADV_SEQUENTIAL) == 0,
+         "madvise (ADV_SEQUENTIAL)");
+  memcpy (ACTUAL, sample, strlen (sample));
+
+  /* Dropping the modified page writes it back to the file. */
+  CHECK (madvise (ACTUAL, 4096, ADV_DONTNEED) == 0,
+         "madvise (ADV_DONTNEED)");
+  read (handle, buf, strlen (sample));
+  CHECK (!memcmp (buf, sample, strlen (sample)),
+         "compare read data against written data");
+
+  /* Touching the page again brings it back from the file. */
+  CHECK (madvise (ACTUAL, 4096, ADV_WILLNEED) == 0,
+         "madvise (ADV_WILLNEED)");
+  CHECK (!memcmp (ACTUAL, sample, strlen (sample)),
+         "compare mapped data against written data");
+
+  if (madvise ((char *) ACTUAL + 1, 4096, ADV_NORMAL) != -1)
+    fail ("madvise() of misaligned address did not fail");
+  if (madvise ((char *) ACTUAL + 4096, 4096, ADV_NORMAL) != -1)
+    fail ("madvise() of unmapped page did not fail");
+  if (madvise (ACTUAL, 4096, ADV_DONTNEED + 1) != -1)
+    fail ("madvise() with bad advice did not fail");
+
+  munmap (map);
+  close (handle);
+}
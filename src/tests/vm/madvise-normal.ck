@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(madvise-normal) begin
+(madvise-normal) create "sample.txt"
+(madvise-normal) open "sample.txt"
+(madvise-normal) mmap "sample.txt"
+(madvise-normal) madvise (ADV_SEQUENTIAL)
+(madvise-normal) madvise (ADV_DONTNEED)
+(madvise-normal) compare read data against written data
+(madvise-normal) madvise (ADV_WILLNEED)
+(madvise-normal) compare mapped data against written data
+(madvise-normal) end
+EOF
+pass;
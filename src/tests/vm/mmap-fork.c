@@ -0,0 +1,36 @@
+/* Maps a file, then forks.  The child must see the same data at
+   the same address under the same mapping id, and unmapping it
+   there must leave the parent's mapping in place. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  char *actual = (char *) 0x10000000;
+  int handle;
+  mapid_t map;
+  pid_t pid;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (handle, actual)) != MAP_FAILED, "mmap \"sample.txt\"");
+
+  pid = fork ();
+  if (pid == 0)
+    {
+      if (memcmp (actual, sample, strlen (sample)))
+        exit (1);
+      munmap (map);
+      exit (0x42);
+    }
+
+  CHECK (pid != PID_ERROR, "fork");
+  CHECK (wait (pid) == 0x42, "wait for child");
+  CHECK (!memcmp (actual, sample, strlen (sample)),
+         "parent's mapping still has same data");
+  munmap (map);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-fork) begin
+(mmap-fork) open "sample.txt"
+(mmap-fork) mmap "sample.txt"
+(mmap-fork) fork
+(mmap-fork) wait for child
+(mmap-fork) parent's mapping still has same data
+(mmap-fork) end
+EOF
+pass;
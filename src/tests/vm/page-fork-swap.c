@@ -0,0 +1,58 @@
+/* Fills 1 MB, then forks.  While the parent keeps checking its
+   copy, the child checks the same pages and overwrites all of
+   them, so that frames shared by the fork are split and pushed
+   out to swap by both processes.  Each must see only its own
+   data throughout. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (1024 * 1024)
+static char buf[SIZE];
+
+/* Returns the byte expected at offset OFS, inverted if FLIP. */
+static char
+pattern (size_t ofs, bool flip) 
+{
+  char c = ofs ^ (ofs >> 12);
+  return flip ? ~c : c;
+}
+
+/* Checks that all of BUF holds the pattern chosen by FLIP. */
+static bool
+verify (bool flip) 
+{
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != pattern (i, flip))
+      return false;
+  return true;
+}
+
+void
+test_main (void) 
+{
+  pid_t pid;
+  size_t i;
+
+  msg ("initialize");
+  for (i = 0; i < SIZE; i++)
+    buf[i] = pattern (i, false);
+
+  pid = fork ();
+  if (pid == 0)
+    {
+      if (!verify (false))
+        exit (1);
+      for (i = 0; i < SIZE; i++)
+        buf[i] = pattern (i, true);
+      exit (verify (true) ? 0x42 : 2);
+    }
+
+  CHECK (pid != PID_ERROR, "fork");
+  CHECK (verify (false), "parent's data intact while child runs");
+  CHECK (wait (pid) == 0x42, "wait for child");
+  CHECK (verify (false), "parent's data intact after child exits");
+}
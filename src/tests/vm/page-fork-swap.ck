@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-fork-swap) begin
+(page-fork-swap) initialize
+(page-fork-swap) fork
+(page-fork-swap) parent's data intact while child runs
+(page-fork-swap) wait for child
+(page-fork-swap) parent's data intact after child exits
+(page-fork-swap) end
+EOF
+pass;
@@ -0,0 +1,71 @@
+/* Checks that pages of an initialized data segment, loaded from
+   the executable only when first touched, come in with the right
+   contents however they are reached, and that the bss after them
+   reads as zeros. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_INTS 1024
+#define PAGE_CNT 64
+
+/* Marks the first and last int of page N of DATA. */
+#define P1(N) [(N) * PAGE_INTS] = (N) + 1, [(N) * PAGE_INTS + PAGE_INTS - 1] = ~(N)
+#define P4(N) P1 (N), P1 ((N) + 1), P1 ((N) + 2), P1 ((N) + 3)
+#define P16(N) P4 (N), P4 ((N) + 4), P4 ((N) + 8), P4 ((N) + 12)
+
+static int data[PAGE_CNT * PAGE_INTS] = { P16 (0), P16 (16), P16 (32),
+                                          P16 (48) };
+static int bss[PAGE_CNT * PAGE_INTS];
+
+/* Checks page N of DATA, which should hold FIRST, LAST and
+   zeros between them. */
+static void
+check_page (int n, int first, int last) 
+{
+  int *page = data + n * PAGE_INTS;
+  int i;
+
+  if (page[0] != first || page[PAGE_INTS - 1] != last)
+    fail ("page %d holds %d...%d, expected %d...%d",
+          n, page[0], page[PAGE_INTS - 1], first, last);
+  for (i = 1; i < PAGE_INTS - 1; i++)
+    if (page[i] != 0)
+      fail ("data[%d] is %d, expected 0", n * PAGE_INTS + i, page[i]);
+}
+
+void
+test_main (void) 
+{
+  int i;
+
+  /* 27 is relatively prime to PAGE_CNT, so this touches every
+     page once in an order that is neither forward nor back. */
+  msg ("read data pages in scattered order");
+  for (i = 0; i < PAGE_CNT; i++) 
+    {
+      int n = i * 27 % PAGE_CNT;
+      check_page (n, n + 1, ~n);
+    }
+
+  msg ("read bss");
+  for (i = 0; i < PAGE_CNT * PAGE_INTS; i++)
+    if (bss[i] != 0)
+      fail ("bss[%d] is %d, expected 0", i, bss[i]);
+
+  msg ("modify data and bss pages");
+  for (i = 0; i < PAGE_CNT; i++) 
+    {
+      data[i * PAGE_INTS] = -i;
+      bss[i * PAGE_INTS] = i;
+    }
+
+  msg ("read data and bss pages backward");
+  for (i = PAGE_CNT - 1; i >= 0; i--) 
+    {
+      check_page (i, -i, ~i);
+      if (bss[i * PAGE_INTS] != i)
+        fail ("bss page %d holds %d, expected %d",
+              i, bss[i * PAGE_INTS], i);
+    }
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-lazy-data) begin
+(page-lazy-data) read data pages in scattered order
+(page-lazy-data) read bss
+(page-lazy-data) modify data and bss pages
+(page-lazy-data) read data and bss pages backward
+(page-lazy-data) end
+EOF
+pass;
@@ -0,0 +1,26 @@
+/* Runs several copies of child-text at once, so that they share
+   their read-only pages, alongside child-linear processes that
+   push those pages out of memory. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 6
+#define LINEAR_CNT 2
+
+void
+test_main (void)
+{
+  pid_t children[CHILD_CNT];
+  pid_t linear[LINEAR_CNT];
+  int i;
+
+  for (i = 0; i < LINEAR_CNT; i++) 
+    CHECK ((linear[i] = exec ("child-linear")) != -1,
+           "exec \"child-linear\"");
+  exec_children ("child-text", children, CHILD_CNT);
+  wait_children (children, CHILD_CNT);
+  for (i = 0; i < LINEAR_CNT; i++) 
+    CHECK (wait (linear[i]) == 0x42, "wait for child-linear %d", i);
+}
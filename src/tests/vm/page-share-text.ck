@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-share-text) begin
+(page-share-text) exec "child-linear"
+(page-share-text) exec "child-linear"
+(page-share-text) exec child 1 of 6: "child-text 0"
+(page-share-text) exec child 2 of 6: "child-text 1"
+(page-share-text) exec child 3 of 6: "child-text 2"
+(page-share-text) exec child 4 of 6: "child-text 3"
+(page-share-text) exec child 5 of 6: "child-text 4"
+(page-share-text) exec child 6 of 6: "child-text 5"
+(page-share-text) wait for child 1 of 6 returned 0 (expected 0)
+(page-share-text) wait for child 2 of 6 returned 1 (expected 1)
+(page-share-text) wait for child 3 of 6 returned 2 (expected 2)
+(page-share-text) wait for child 4 of 6 returned 3 (expected 3)
+(page-share-text) wait for child 5 of 6 returned 4 (expected 4)
+(page-share-text) wait for child 6 of 6 returned 5 (expected 5)
+(page-share-text) wait for child-linear 0
+(page-share-text) wait for child-linear 1
+(page-share-text) end
+EOF
+pass;
@@ -0,0 +1,67 @@
+/* Reads 4 MB of bss, more than fits in memory unless its pages
+   share a frame of zeros, then writes to some of those pages,
+   from user code and through read(), and checks that each write
+   lands in a page of its own. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 1024
+static char buf[PAGE_CNT * PAGE_SIZE];
+
+/* Returns true if SIZE bytes starting at P are all zero. */
+static bool
+is_zero (const char *p, size_t size) 
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    if (p[i] != 0)
+      return false;
+  return true;
+}
+
+void
+test_main (void) 
+{
+  char *page;
+  size_t len = strlen (sample);
+  int handle;
+  int i;
+
+  CHECK (is_zero (buf, sizeof buf), "read bss");
+
+  msg ("write every 16th page");
+  for (i = 0; i < PAGE_CNT; i += 16)
+    buf[i * PAGE_SIZE + i] = i / 16 + 1;
+
+  page = buf + 8 * PAGE_SIZE;
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, page, len) == (int) len,
+         "read \"sample.txt\" into an untouched page");
+  close (handle);
+
+  for (i = 0; i < PAGE_CNT; i++) 
+    {
+      char *p = buf + i * PAGE_SIZE;
+
+      if (i % 16 == 0)
+        {
+          if (p[i] != i / 16 + 1 || !is_zero (p, i)
+              || !is_zero (p + i + 1, PAGE_SIZE - i - 1))
+            fail ("page %d does not hold just the byte written", i);
+        }
+      else if (i == 8)
+        {
+          if (memcmp (p, sample, len) || !is_zero (p + len, PAGE_SIZE - len))
+            fail ("page %d does not hold just \"sample.txt\"", i);
+        }
+      else if (!is_zero (p, PAGE_SIZE))
+        fail ("page %d is no longer all zeros", i);
+    }
+  msg ("verified every page");
+}
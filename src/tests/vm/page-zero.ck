@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-zero) begin
+(page-zero) read bss
+(page-zero) write every 16th page
+(page-zero) open "sample.txt"
+(page-zero) read "sample.txt" into an untouched page
+(page-zero) verified every page
+(page-zero) end
+EOF
+pass;
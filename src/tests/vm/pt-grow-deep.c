@@ -0,0 +1,36 @@
+/* Grows the stack about 1 MB through deep recursion, with each
+   level filling a buffer of its own and checking it again on the
+   way back out.  Then does it a second time over the pages that
+   the first pass left behind.  This must succeed. */
+
+#include <string.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define DEPTH 1024
+#define FRAME_SIZE 1000
+
+/* Recurses DEPTH - LEVEL more levels, returning the number of
+   levels whose buffers survived intact. */
+static int
+recurse (int level) 
+{
+  volatile char buf[FRAME_SIZE];
+  int i, ok;
+
+  for (i = 0; i < FRAME_SIZE; i++)
+    buf[i] = level + i;
+  ok = level + 1 < DEPTH ? recurse (level + 1) : 0;
+  for (i = 0; i < FRAME_SIZE; i++)
+    if (buf[i] != (char) (level + i))
+      fail ("level %d: byte %d is %d, expected %d",
+            level, i, buf[i], (char) (level + i));
+  return ok + 1;
+}
+
+void
+test_main (void) 
+{
+  CHECK (recurse (0) == DEPTH, "recurse %d levels", DEPTH);
+  CHECK (recurse (0) == DEPTH, "recurse %d levels again", DEPTH);
+}
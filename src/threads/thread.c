@@ -71,6 +71,10 @@ static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+#ifdef USERPROG
+static hash_hash_func child_hash;
+static hash_less_func child_less;
+#endif
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -105,6 +109,13 @@ thread_init (void)
 void
 thread_start (void) 
 {
+#ifdef USERPROG
+  /* The initial thread was set up before malloc() was available,
+     so give it its children table now. */
+  if (!hash_init (&initial_thread->children, child_hash, child_less, NULL))
+    PANIC ("out of memory for initial thread's children");
+#endif
+
   /* Create the idle thread. */
   struct semaphore idle_started;
   sema_init (&idle_started, 0);
@@ -183,17 +194,31 @@ thread_create (const char *name, int priority,
   init_thread (t, name, priority);
   tid = t->tid = allocate_tid ();
 
-  /* Set new thread's parent as current thread. */
-  t->parent = thread_current ();
-
-  /* Create child and add it to current threads children list. */
+#ifdef USERPROG
+  /* Create child and add it to current threads children table. 
+     It is shared by the parent and the new thread. */
   struct thread_child *new_c = malloc (sizeof(struct thread_child));
-  new_c->child_thread = t;
+  if (new_c == NULL)
+    {
+      palloc_free_page (t);
+      return TID_ERROR;
+    }
+  if (!hash_init (&t->children, child_hash, child_less, NULL))
+    {
+      free (new_c);
+      palloc_free_page (t);
+      return TID_ERROR;
+    }
   new_c->tid = t->tid;
   new_c->load_success = false;
-  new_c->has_been_waited_on = false;
-  new_c->exit_status = STILL_ALIVE;  
-  list_push_back (&thread_current()->children, &new_c->child_elem);
+  new_c->has_exited = false;
+  new_c->exit_status = -1;
+  sema_init (&new_c->load_sema, 0);
+  new_c->parent = thread_current ();
+  new_c->ref_cnt = 2;
+  hash_insert (&thread_current ()->children, &new_c->child_elem);
+  t->child_record = new_c;
+#endif
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -280,25 +305,53 @@ thread_current (void)
   return t;
 }
 
-/* Finds a child thread in a given list from child's TID.
-   Returns NULL if child does not exist in list. */
+/* Finds a child thread in a given table from child's TID.
+   Returns NULL if child does not exist in table. */
 struct thread_child *
-thread_get_child (struct list *child_list, tid_t child_tid)
+thread_get_child (struct hash *children, tid_t child_tid)
 {
-  if (!list_empty (child_list))
-  {
-    struct list_elem *e;   
-    for (e = list_begin (child_list); e != list_end (child_list); e = list_next (e))
-    { 
-      struct thread_child *child = list_entry (e, struct thread_child, child_elem);
-      if(child->tid == child_tid)
-        return child;
-    }
-  }
+  struct thread_child key;
+  struct hash_elem *e;
+
+  key.tid = child_tid;
+  e = hash_find (children, &key.child_elem);
+  return e != NULL ? hash_entry (e, struct thread_child, child_elem) : NULL;
+}
+
+/* Drops one of the two references to child record C, held by 
+   the parent and by the child itself, and frees C when both 
+   are gone. */
+void
+thread_release_child (struct thread_child *c)
+{
+  enum intr_level old_level = intr_disable ();
+  bool last = --c->ref_cnt == 0;
+  intr_set_level (old_level);
 
-  return NULL;
+  if (last)
+    free (c);
 }
 
+#ifdef USERPROG
+/* Returns a hash value for child record E. */
+static unsigned
+child_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct thread_child *c = hash_entry (e, struct thread_child, child_elem);
+  return hash_int (c->tid);
+}
+
+/* Returns true if child record A precedes child record B. */
+static bool
+child_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+  const struct thread_child *a = hash_entry (a_, struct thread_child, child_elem);
+  const struct thread_child *b = hash_entry (b_, struct thread_child, child_elem);
+  return a->tid < b->tid;
+}
+#endif
+
 /* Returns the running thread's tid. */
 tid_t
 thread_tid (void) 
@@ -496,13 +549,19 @@ init_thread (struct thread *t, const char *name, int priority)
   t->magic = THREAD_MAGIC;
 
 #ifdef USERPROG
-  list_init(&t->children);
-  sema_init(&t->load_sema, 0);
-  sema_init(&t->exec_sema, 0);
-  t->parent = NULL;
-  list_init (&t->open_files);
+  list_init (&t->exited_children);
+  sema_init (&t->child_exit_sema, 0);
+  t->child_record = NULL;
+  t->fd_table = NULL;
+  t->fd_table_size = 0;
+  t->fd_free_hint = FD_FIRST;
   t->executable_file = NULL;
-  t->fd_counter = 2;
+  t->syscall_frame = NULL;
+#endif
+#ifdef VM
+  t->pages = NULL;
+  lock_init (&t->page_lock);
+  list_init (&t->mappings);
 #endif
 
   old_level = intr_disable ();
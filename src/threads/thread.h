@@ -2,6 +2,7 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
 #include <list.h>
 #include <stdint.h>
 
@@ -30,7 +31,7 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
-#define STILL_ALIVE 1                  /* Thread is still executing. */
+#define FD_FIRST 2                     /* Lowest fd for files; 0 and 1 are the console. */
 
 /* A kernel thread or user process.
 
@@ -87,7 +88,9 @@ typedef int tid_t;
    semaphore wait list (synch.c).  It can be used these two ways
    only because they are mutually exclusive: only a thread in the
    ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+   blocked state is on a semaphore wait list.  A thread sleeping
+   in timer_sleep() is blocked, so it uses `elem' for the timer's
+   sleep list instead. */
 struct thread
   {
     /* Owned by thread.c. */
@@ -101,16 +104,31 @@ struct thread
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
 
+    /* Owned by devices/timer.c. */
+    int64_t wakeup_tick;                /* Tick to wake from timer_sleep(). */
+    bool wake_pending;                  /* timer_wake() called while awake. */
+
 #ifdef USERPROG
     /* Owned by userprog/process.c. */
     uint32_t *pagedir;                  /* Page directory. */
-    struct thread *parent;              /* Pointer to this thread's parent. */
-    struct semaphore load_sema;         /* Parent waits for thread to load (or fail loading). */
-    struct semaphore exec_sema;         /* Parent waits for child to finish executing (if not already finished). */
-    struct list children;               /* List of all children that have been spawned by this thread. */
-    struct list open_files;             /* A list of struct thread_open_file. */ 
+    struct thread_child *child_record;  /* This thread's entry in its parent's children, or NULL. */
+    struct hash children;               /* Children not yet waited for, keyed by tid. */
+    struct list exited_children;        /* Children that have exited but not been waited for. */
+    struct semaphore child_exit_sema;   /* Upped each time a child exits. */
+    struct file **fd_table;             /* Open files indexed by fd, null if slot is free. */
+    int fd_table_size;                  /* Number of slots in fd_table. */
+    int fd_free_hint;                   /* No free slot below this fd. */
     struct file *executable_file;       /* Pointer to executable file that started thread. */
-    int fd_counter;                     /* Seed generator for files. */
+    struct intr_frame *syscall_frame;   /* User context of the syscall in progress. */
+#endif
+#ifdef VM
+    /* Owned by vm/page.c. */
+    struct hash *pages;                 /* Supplemental page table. */
+    struct lock page_lock;              /* Guards pages and pagedir against eviction. */
+
+    /* Owned by vm/mmap.c. */
+    struct list mappings;               /* Memory-mapped files. */
+    int next_mapid;                     /* Id for the next mapping. */
 #endif
 
     /* Owned by thread.c. */
@@ -118,21 +136,21 @@ struct thread
   };
 
 #ifdef USERPROG
-struct thread_open_file
-   {
-      struct list_elem elem;
-      int fd;
-      struct file *file;
-   };
-
+/* What a parent knows about one of its children.  Shared by the 
+   parent and the child, and freed once both are done with it, so 
+   that either may exit first.  The parent is done with it once it 
+   has waited for the child. */
 struct thread_child
    {
-      struct list_elem child_elem;
-      struct thread *child_thread;
-      tid_t tid;
-      bool load_success;
-      bool has_been_waited_on;
-      int exit_status;
+      struct hash_elem child_elem;      /* Element in parent's children table. */
+      tid_t tid;                        /* Child's tid. */
+      bool load_success;                /* Did the child's executable load? */
+      bool has_exited;                  /* Has the child exited? */
+      int exit_status;                  /* Child's exit status, -1 until it calls exit(). */
+      struct semaphore load_sema;       /* Upped when the child finishes loading. */
+      struct thread *parent;            /* Parent, or NULL once it has exited. */
+      struct list_elem exit_elem;       /* Element in parent's exited_children. */
+      int ref_cnt;                      /* Parent and/or child still using this. */
    };
 #endif
 
@@ -154,7 +172,8 @@ void thread_block (void);
 void thread_unblock (struct thread *);
 
 struct thread *thread_current (void);
-struct thread_child *thread_get_child (struct list *, tid_t);
+struct thread_child *thread_get_child (struct hash *, tid_t);
+void thread_release_child (struct thread_child *);
 tid_t thread_tid (void);
 const char *thread_name (void);
 
@@ -0,0 +1,562 @@
+#include "userprog/cow.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdint.h>
+#include <string.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#ifdef VM
+#include "vm/frame.h"
+#endif
+
+/* A user frame mapped by more than one page directory, or a
+   frame holding read-only program text that other processes
+   running the same executable may map.
+
+   Most frames are mapped exactly once, so only frames that have
+   been shared have an entry; a frame with no entry has a single
+   mapping.  An entry stays until its frame is freed, evicted, or
+   written by its one remaining mapper, so that the next process
+   to load the same page of text can find it.
+
+   With VM, an entry also remembers which process maps the frame
+   where, for the frame table.  Each mapping adds its thread and
+   user address into OWNER_XOR and UPAGE_XOR with exclusive-or,
+   and dropping it takes them out the same way, so that once one
+   mapping is left they are its thread and address. */
+struct shared_frame
+  {
+    struct hash_elem elem;      /* Element in shared_frames. */
+    struct hash_elem text_elem; /* Element in text_frames, if text. */
+    void *kpage;                /* Kernel virtual address of frame. */
+    int map_cnt;                /* Number of mappings. */
+    struct inode *inode;        /* Text frame's file, or null. */
+    off_t ofs;                  /* Text frame's offset in INODE. */
+    size_t read_bytes;          /* Bytes of text read; the rest are zero. */
+#ifdef VM
+    uintptr_t owner_xor;        /* Mapping threads, exclusive-ored. */
+    uintptr_t upage_xor;        /* Mapping addresses, exclusive-ored. */
+#endif
+  };
+
+/* Shared frames, keyed by kernel virtual address. */
+static struct hash shared_frames;
+
+/* Text frames, also in shared_frames, keyed by INODE, OFS and
+   READ_BYTES.  A page at the end of one segment and at the start
+   of the next may come from the same place in the file but be
+   zeroed differently, hence the last. */
+static struct hash text_frames;
+
+/* A frame of zeros, mapped read-only in place of every page of
+   zeros that no process has written yet.  Allocated from the
+   kernel pool, so that it is never evicted, and never freed. */
+static void *zero_page;
+
+/* Protects shared_frames, text_frames, and every count in
+   them.  With VM, the frame table's lock may be held while
+   acquiring this one, so this one must never be held while
+   calling into the frame table. */
+static struct lock cow_lock;
+
+static hash_hash_func shared_frame_hash, text_frame_hash;
+static hash_less_func shared_frame_less, text_frame_less;
+static struct shared_frame *lookup (void *kpage);
+static struct shared_frame *lookup_text (struct inode *, off_t ofs,
+                                         size_t read_bytes);
+static void add_mapping (struct shared_frame *, struct thread *,
+                         void *upage);
+static bool drop_mapping (struct shared_frame *, void *upage);
+static void forget (struct shared_frame *);
+static void *alloc_frame (void *upage, enum palloc_flags);
+static void free_frame (void *kpage);
+static void pin_frame (void *kpage);
+static void unpin_frame (void *kpage);
+static struct thread *get_owner (void *kpage, void **upage);
+static void set_owner (void *kpage, void *upage);
+
+/* Initializes the shared frame table. */
+void
+cow_init (void) 
+{
+  hash_init (&shared_frames, shared_frame_hash, shared_frame_less, NULL);
+  hash_init (&text_frames, text_frame_hash, text_frame_less, NULL);
+  lock_init (&cow_lock);
+  zero_page = palloc_get_page (PAL_ZERO | PAL_ASSERT);
+}
+
+/* Returns the shared zero page.  It may be mapped any number of
+   times; mapping it needs no call to cow_share(). */
+void *
+cow_zero_page (void) 
+{
+  return zero_page;
+}
+
+/* Records that user frame KPAGE, mapped at UPAGE by the process
+   being forked, is now also mapped at UPAGE by the running
+   process.  Returns false if memory for the record cannot be
+   allocated. */
+bool
+cow_share (void *kpage, void *upage) 
+{
+  struct shared_frame *f;
+  struct thread *owner;
+  void *owner_upage;
+  bool success = true;
+
+  ASSERT (pg_ofs (kpage) == 0);
+
+  if (kpage == zero_page)
+    return true;
+
+  /* If KPAGE has no entry yet, its one mapping so far is the
+     frame table's record.  The caller holds that process's
+     page_lock, so the record cannot change under us. */
+  owner = get_owner (kpage, &owner_upage);
+
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  if (f == NULL)
+    {
+      f = malloc (sizeof *f);
+      if (f != NULL)
+        {
+          f->kpage = kpage;
+          f->map_cnt = 0;
+          f->inode = NULL;
+          f->ofs = 0;
+          f->read_bytes = 0;
+#ifdef VM
+          f->owner_xor = f->upage_xor = 0;
+#endif
+          add_mapping (f, owner, owner_upage);
+          hash_insert (&shared_frames, &f->elem);
+        }
+      else
+        success = false;
+    }
+  if (f != NULL)
+    add_mapping (f, thread_current (), upage);
+  lock_release (&cow_lock);
+
+  return success;
+}
+
+/* Drops the running process's mapping of user frame KPAGE at
+   UPAGE, freeing the frame if it was the last. */
+void
+cow_release (void *kpage, void *upage) 
+{
+  struct shared_frame *f;
+  struct inode *inode = NULL;
+  bool last;
+
+  if (kpage == zero_page)
+    return;
+
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  last = f == NULL;
+  if (f != NULL) 
+    {
+      inode = f->inode;
+      last = drop_mapping (f, upage);
+    }
+  lock_release (&cow_lock);
+
+  if (last) 
+    {
+      free_frame (kpage);
+      inode_close (inode);
+    }
+}
+
+/* Returns the text frame holding the READ_BYTES bytes of
+   program text at offset OFS in INODE, followed by zeros,
+   counting the running process's mapping of it at UPAGE.
+   Returns a null pointer if no process has that page loaded. */
+void *
+cow_get_text (struct inode *inode, off_t ofs, size_t read_bytes,
+              void *upage) 
+{
+  struct shared_frame *f;
+  void *kpage = NULL;
+
+  lock_acquire (&cow_lock);
+  f = lookup_text (inode, ofs, read_bytes);
+  if (f != NULL) 
+    {
+      add_mapping (f, thread_current (), upage);
+      kpage = f->kpage;
+    }
+  lock_release (&cow_lock);
+
+  return kpage;
+}
+
+/* Offers frame KPAGE, which the caller has just filled as
+   cow_get_text() describes and is about to map read-only at
+   UPAGE, for other processes to share.  Returns the frame
+   the caller should map.  That is usually KPAGE, but if another
+   process loaded the same page in the meantime, KPAGE is freed
+   and the other frame is returned instead.  If memory for the
+   record cannot be allocated, KPAGE is simply not shared. */
+void *
+cow_add_text (void *kpage, struct inode *inode, off_t ofs,
+              size_t read_bytes, void *upage) 
+{
+  struct shared_frame *f;
+
+  ASSERT (pg_ofs (kpage) == 0);
+
+  lock_acquire (&cow_lock);
+  f = lookup_text (inode, ofs, read_bytes);
+  if (f != NULL) 
+    {
+      void *shared = f->kpage;
+
+      add_mapping (f, thread_current (), upage);
+      lock_release (&cow_lock);
+      free_frame (kpage);
+      return shared;
+    }
+
+  f = malloc (sizeof *f);
+  if (f != NULL) 
+    {
+      f->kpage = kpage;
+      f->map_cnt = 0;
+      f->inode = inode_reopen (inode);
+      f->ofs = ofs;
+      f->read_bytes = read_bytes;
+#ifdef VM
+      f->owner_xor = f->upage_xor = 0;
+#endif
+      add_mapping (f, thread_current (), upage);
+      hash_insert (&shared_frames, &f->elem);
+      hash_insert (&text_frames, &f->text_elem);
+    }
+  lock_release (&cow_lock);
+
+  return kpage;
+}
+
+/* Gives the caller a frame of its own with the contents of user
+   frame KPAGE, for its mapping at UPAGE, which is about to be
+   written.  If that is KPAGE's only mapping, returns KPAGE
+   itself.  Otherwise, returns a new copy, and KPAGE loses the
+   caller's mapping; a copy of the zero page is simply a zeroed
+   frame.  Returns a null pointer, leaving KPAGE
+   alone, if no frame is free for the copy. */
+void *
+cow_unshare (void *kpage, void *upage) 
+{
+  struct shared_frame *f;
+  void *copy;
+  bool sole;
+
+  if (kpage == zero_page)
+    return alloc_frame (upage, PAL_ZERO);
+
+  /* If KPAGE turns out to be ours alone, the frame table goes by
+     its own record once KPAGE's entry is gone, so that record
+     must be right by then. */
+  set_owner (kpage, upage);
+
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  sole = f == NULL || f->map_cnt == 1;
+  if (f != NULL && sole)
+    forget (f);
+  lock_release (&cow_lock);
+  if (sole)
+    return kpage;
+
+  /* Getting a frame may mean evicting one, which cannot be done
+     under cow_lock, so the other mappings may have gone by the
+     time we have it.  KPAGE itself must stay put meanwhile. */
+  pin_frame (kpage);
+  copy = alloc_frame (upage, 0);
+  unpin_frame (kpage);
+  if (copy == NULL)
+    return NULL;
+
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  sole = f == NULL || f->map_cnt == 1;
+  if (f != NULL && sole)
+    forget (f);
+  else if (f != NULL) 
+    {
+      /* Text frames are mapped read-only, never copy-on-write. */
+      ASSERT (f->inode == NULL);
+
+      memcpy (copy, kpage, PGSIZE);
+      drop_mapping (f, upage);
+    }
+  lock_release (&cow_lock);
+
+  if (sole) 
+    {
+      free_frame (copy);
+      copy = kpage;
+    }
+  return copy;
+}
+
+/* Prepares user frame KPAGE, which has just one mapping, to be
+   taken away from that mapping by the frame table.  Returns true
+   if KPAGE may be evicted, false if it is still mapped more than
+   once.  A frame that was shared, including a text frame, may be
+   evicted once one process is left mapping it, but since it can
+   then no longer be shared, it is forgotten here. */
+bool
+cow_evict (void *kpage) 
+{
+  struct shared_frame *f;
+  struct inode *inode = NULL;
+  bool success;
+
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  success = f == NULL || f->map_cnt == 1;
+  if (f != NULL && success) 
+    {
+      inode = f->inode;
+      forget (f);
+    }
+  lock_release (&cow_lock);
+
+  inode_close (inode);
+  return success;
+}
+
+#ifdef VM
+/* For the frame table, which may not trust its own record of
+   which process maps user frame KPAGE if KPAGE has been shared.
+   Returns false if KPAGE has never been shared, or has been
+   forgotten since, in which case the frame table's record
+   stands.  Otherwise returns true, and, if only one process T
+   maps KPAGE now, tries to acquire T's page_lock without waiting,
+   unless the running thread holds it already.  If that succeeds,
+   stores T in *OWNER, the address at which T maps KPAGE in
+   *UPAGE, and whether the running thread already held the lock
+   in *HELD.  In any other case, stores a null pointer in *OWNER.
+
+   The page_lock is taken here, under cow_lock, because T cannot
+   drop its mapping, and so cannot exit, while we hold cow_lock,
+   and once we hold T's page_lock it cannot do so either. */
+bool
+cow_owner (void *kpage, struct thread **owner, void **upage, bool *held) 
+{
+  struct shared_frame *f;
+
+  *owner = NULL;
+  lock_acquire (&cow_lock);
+  f = lookup (kpage);
+  if (f != NULL && f->map_cnt == 1) 
+    {
+      struct thread *t = (struct thread *) f->owner_xor;
+
+      *held = lock_held_by_current_thread (&t->page_lock);
+      if (*held || lock_try_acquire (&t->page_lock)) 
+        {
+          *owner = t;
+          *upage = (void *) f->upage_xor;
+        }
+    }
+  lock_release (&cow_lock);
+
+  return f != NULL;
+}
+#endif
+
+/* Counts a new mapping of shared frame F, by thread T at UPAGE.
+   cow_lock must be held. */
+static void
+add_mapping (struct shared_frame *f, struct thread *t UNUSED,
+             void *upage UNUSED) 
+{
+  f->map_cnt++;
+#ifdef VM
+  f->owner_xor ^= (uintptr_t) t;
+  f->upage_xor ^= (uintptr_t) upage;
+#endif
+}
+
+/* Drops the running process's mapping of shared frame F at
+   UPAGE, deleting F if that was the last.  Returns true if it
+   was, in which case the caller must free the frame and close
+   the inode, if any.  cow_lock must be held. */
+static bool
+drop_mapping (struct shared_frame *f, void *upage UNUSED) 
+{
+  f->map_cnt--;
+#ifdef VM
+  f->owner_xor ^= (uintptr_t) thread_current ();
+  f->upage_xor ^= (uintptr_t) upage;
+#endif
+  if (f->map_cnt == 0) 
+    {
+      forget (f);
+      return true;
+    }
+  return false;
+}
+
+/* Deletes shared frame F, but not its frame or inode.
+   cow_lock must be held. */
+static void
+forget (struct shared_frame *f) 
+{
+  hash_delete (&shared_frames, &f->elem);
+  if (f->inode != NULL)
+    hash_delete (&text_frames, &f->text_elem);
+  free (f);
+}
+
+/* Returns a new user frame for the running process to map at
+   UPAGE, or a null pointer if none is free.  FLAGS is as for
+   palloc_get_page(); PAL_USER is implied. */
+static void *
+alloc_frame (void *upage UNUSED, enum palloc_flags flags) 
+{
+#ifdef VM
+  return frame_alloc (upage, flags);
+#else
+  return palloc_get_page (PAL_USER | flags);
+#endif
+}
+
+/* Frees user frame KPAGE. */
+static void
+free_frame (void *kpage) 
+{
+#ifdef VM
+  frame_free (kpage);
+#else
+  palloc_free_page (kpage);
+#endif
+}
+
+/* Keeps user frame KPAGE from being evicted until
+   unpin_frame(). */
+static void
+pin_frame (void *kpage UNUSED) 
+{
+#ifdef VM
+  frame_pin (kpage);
+#endif
+}
+
+/* Undoes pin_frame(). */
+static void
+unpin_frame (void *kpage UNUSED) 
+{
+#ifdef VM
+  frame_unpin (kpage);
+#endif
+}
+
+/* Returns the process that the frame table records as mapping
+   user frame KPAGE, storing the address at which it does so in
+   *UPAGE.  Without VM there is no such record, and nothing needs
+   it, so returns a null pointer. */
+static struct thread *
+get_owner (void *kpage UNUSED, void **upage) 
+{
+#ifdef VM
+  return frame_get_owner (kpage, upage);
+#else
+  *upage = NULL;
+  return NULL;
+#endif
+}
+
+/* Tells the frame table that user frame KPAGE is mapped by the
+   running process, at UPAGE. */
+static void
+set_owner (void *kpage UNUSED, void *upage UNUSED) 
+{
+#ifdef VM
+  frame_set_owner (kpage, thread_current (), upage);
+#endif
+}
+
+/* Returns the shared frame record for KPAGE, or a null pointer
+   if KPAGE is not shared.  cow_lock must be held. */
+static struct shared_frame *
+lookup (void *kpage) 
+{
+  struct shared_frame key;
+  struct hash_elem *e;
+
+  key.kpage = kpage;
+  e = hash_find (&shared_frames, &key.elem);
+  return e != NULL ? hash_entry (e, struct shared_frame, elem) : NULL;
+}
+
+/* Returns the text frame record for READ_BYTES bytes at OFS in
+   INODE, or a null pointer if there is none.  cow_lock must be
+   held. */
+static struct shared_frame *
+lookup_text (struct inode *inode, off_t ofs, size_t read_bytes) 
+{
+  struct shared_frame key;
+  struct hash_elem *e;
+
+  key.inode = inode;
+  key.ofs = ofs;
+  key.read_bytes = read_bytes;
+  e = hash_find (&text_frames, &key.text_elem);
+  return e != NULL ? hash_entry (e, struct shared_frame, text_elem) : NULL;
+}
+
+/* Returns a hash value for shared frame E. */
+static unsigned
+shared_frame_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct shared_frame *f = hash_entry (e, struct shared_frame, elem);
+  return hash_bytes (&f->kpage, sizeof f->kpage);
+}
+
+/* Returns true if shared frame A precedes shared frame B. */
+static bool
+shared_frame_less (const struct hash_elem *a_, const struct hash_elem *b_,
+                   void *aux UNUSED) 
+{
+  const struct shared_frame *a = hash_entry (a_, struct shared_frame, elem);
+  const struct shared_frame *b = hash_entry (b_, struct shared_frame, elem);
+  return a->kpage < b->kpage;
+}
+
+/* Returns a hash value for text frame E. */
+static unsigned
+text_frame_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct shared_frame *f = hash_entry (e, struct shared_frame,
+                                             text_elem);
+  return (hash_bytes (&f->inode, sizeof f->inode)
+          ^ hash_int (f->ofs) ^ hash_int (f->read_bytes));
+}
+
+/* Returns true if text frame A precedes text frame B. */
+static bool
+text_frame_less (const struct hash_elem *a_, const struct hash_elem *b_,
+                 void *aux UNUSED) 
+{
+  const struct shared_frame *a = hash_entry (a_, struct shared_frame,
+                                             text_elem);
+  const struct shared_frame *b = hash_entry (b_, struct shared_frame,
+                                             text_elem);
+  if (a->inode != b->inode)
+    return a->inode < b->inode;
+  if (a->ofs != b->ofs)
+    return a->ofs < b->ofs;
+  return a->read_bytes < b->read_bytes;
+}
@@ -0,0 +1,33 @@
+#ifndef USERPROG_COW_H
+#define USERPROG_COW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct inode;
+struct thread;
+
+/* Reference counts for user frames mapped by more than one page
+   directory, as fork() leaves them until one side writes, and
+   for read-only program text shared by every process running
+   the same executable.  Also the zero page, which stands in for
+   pages of zeros until they are written. */
+
+void cow_init (void);
+void *cow_zero_page (void);
+bool cow_share (void *kpage, void *upage);
+void cow_release (void *kpage, void *upage);
+void *cow_unshare (void *kpage, void *upage);
+bool cow_evict (void *kpage);
+#ifdef VM
+bool cow_owner (void *kpage, struct thread **owner, void **upage,
+                bool *held);
+#endif
+
+void *cow_get_text (struct inode *, off_t ofs, size_t read_bytes,
+                    void *upage);
+void *cow_add_text (void *kpage, struct inode *, off_t ofs,
+                    size_t read_bytes, void *upage);
+
+#endif /* userprog/cow.h */
@@ -2,9 +2,15 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/pagedir.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/vaddr.h"
 #include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -148,6 +154,55 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+#ifdef VM
+  /* A page that has not been touched before is brought in, or a
+     stack page added for an access just below the stack pointer,
+     and the access retried.  This comes before the check for
+     uaccess.c, so that system calls can touch such pages too.
+     In a system call, the user's stack pointer is the one saved
+     on entry to the kernel, which is at or below everything on
+     the user stack when the kernel touches it: the int $0x30
+     that entered the kernel pushes nothing on the user stack. */
+  if (not_present) 
+    {
+      struct thread *t = thread_current ();
+      void *esp = user ? f->esp
+                  : t->syscall_frame != NULL ? t->syscall_frame->esp : NULL;
+
+      if (page_in (fault_addr, write)
+          || (esp != NULL && page_grow_stack (fault_addr, esp, user)))
+        return;
+    }
+#endif
+
+  /* A write to a page shared copy-on-write since fork(), or to
+     a page of zeros still mapped to the zero page, gets a
+     private copy of the page and then retries.  This applies to
+     writes by the kernel on the process's behalf, too. */
+#ifdef VM
+  if (!not_present && write && page_unshare (fault_addr))
+    return;
+#else
+  if (!not_present && write && is_user_vaddr (fault_addr)
+      && thread_current ()->pagedir != NULL
+      && pagedir_break_cow (thread_current ()->pagedir, fault_addr))
+    return;
+#endif
+
+  /* A fault in the kernel on a user address, raised by one of
+     the user memory accessors in userprog/uaccess.c, means the
+     user passed a bad pointer.  They leave the address to resume
+     at in EAX; go there with EAX set to -1 to report the failure.
+     A kernel fault anywhere else falls through to kill(), which
+     panics. */
+  if (!user && is_user_vaddr (fault_addr)
+      && (char *) f->eip >= uaccess_start && (char *) f->eip < uaccess_end)
+    {
+      f->eip = (void (*) (void)) f->eax;
+      f->eax = 0xffffffff;
+      return;
+    }
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
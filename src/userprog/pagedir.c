@@ -5,7 +5,15 @@
 #include "threads/init.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
+#include "userprog/cow.h"
 
+/* Marks a PTE that maps a frame shared copy-on-write: read-only
+   in the page table, but writable by the process, which gets a
+   private copy of the frame on its first write.  One of the
+   PTE_AVL bits. */
+#define PTE_COW 0x200
+
+static uint32_t *lookup_page (uint32_t *, const void *, bool);
 static uint32_t *active_pd (void);
 static void invalidate_pagedir (uint32_t *);
 
@@ -23,7 +31,8 @@ pagedir_create (void)
 }
 
 /* Destroys page directory PD, freeing all the pages it
-   references. */
+   references, except those still mapped by another page
+   directory after fork(). */
 void
 pagedir_destroy (uint32_t *pd) 
 {
@@ -41,12 +50,78 @@ pagedir_destroy (uint32_t *pd)
         
         for (pte = pt; pte < pt + PGSIZE / sizeof *pte; pte++)
           if (*pte & PTE_P) 
-            palloc_free_page (pte_get_page (*pte));
+            cow_release (pte_get_page (*pte),
+                         (void *) (((pde - pd) << PDSHIFT)
+                                   | ((pte - pt) << PTSHIFT)));
         palloc_free_page (pt);
       }
   palloc_free_page (pd);
 }
 
+/* Maps every user page in page directory SRC into page
+   directory DST, which must have no user mappings yet, sharing
+   the frames instead of copying them.  Writable pages become
+   read-only and copy-on-write in both directories; see
+   pagedir_break_cow().  Returns true if successful, false if
+   memory allocation failed, in which case DST may be partly
+   filled in but is still safe to destroy. */
+bool
+pagedir_copy_cow (uint32_t *dst, uint32_t *src) 
+{
+  uint32_t *pde;
+
+  ASSERT (dst != init_page_dir && src != init_page_dir);
+
+  for (pde = src; pde < src + pd_no (PHYS_BASE); pde++)
+    if (*pde & PTE_P) 
+      {
+        uint32_t *pt = pde_get_pt (*pde);
+        size_t i;
+
+        for (i = 0; i < PGSIZE / sizeof *pt; i++)
+          if (pt[i] & PTE_P) 
+            {
+              void *upage = (void *) (((pde - src) << PDSHIFT)
+                                      | (i << PTSHIFT));
+              uint32_t *dst_pte = lookup_page (dst, upage, true);
+
+              if (dst_pte == NULL || !cow_share (pte_get_page (pt[i]), upage))
+                return false;
+              if (pt[i] & PTE_W)
+                pt[i] = (pt[i] & ~PTE_W) | PTE_COW;
+              *dst_pte = pt[i];
+            }
+      }
+  invalidate_pagedir (src);
+  return true;
+}
+
+/* Handles a write to user virtual address UADDR in PD, if it
+   is a copy-on-write page, by giving PD a private, writable
+   copy of the page.  Returns true if successful, false if UADDR
+   is not a copy-on-write page or no frame is free for the
+   copy. */
+bool
+pagedir_break_cow (uint32_t *pd, const void *uaddr) 
+{
+  uint32_t *pte;
+  void *kpage;
+
+  ASSERT (is_user_vaddr (uaddr));
+
+  pte = lookup_page (pd, uaddr, false);
+  if (pte == NULL || (*pte & (PTE_P | PTE_COW)) != (PTE_P | PTE_COW))
+    return false;
+
+  kpage = cow_unshare (pte_get_page (*pte), pg_round_down (uaddr));
+  if (kpage == NULL)
+    return false;
+
+  *pte = pte_create_user (kpage, true) | (*pte & (PTE_A | PTE_D));
+  invalidate_pagedir (pd);
+  return true;
+}
+
 /* Returns the address of the page table entry for virtual
    address VADDR in page directory PD.
    If PD does not have a page table for VADDR, behavior depends
@@ -118,6 +193,24 @@ pagedir_set_page (uint32_t *pd, void *upage, void *kpage, bool writable)
     return false;
 }
 
+/* Maps user virtual page UPAGE in PD to the shared zero page,
+   in place of a page of zeros that has not been written yet.
+   The mapping is read-only.  If WRITABLE is true, it is also
+   copy-on-write, so that the first write gives PD a zeroed frame
+   of its own; see pagedir_break_cow().
+   UPAGE must not already be mapped.
+   Returns true if successful, false if memory allocation
+   failed. */
+bool
+pagedir_set_zero_page (uint32_t *pd, void *upage, bool writable) 
+{
+  if (!pagedir_set_page (pd, upage, cow_zero_page (), false))
+    return false;
+  if (writable)
+    *lookup_page (pd, upage, false) |= PTE_COW;
+  return true;
+}
+
 /* Looks up the physical address that corresponds to user virtual
    address UADDR in PD.  Returns the kernel virtual address
    corresponding to that physical address, or a null pointer if
@@ -156,6 +249,17 @@ pagedir_clear_page (uint32_t *pd, void *upage)
     }
 }
 
+/* Returns true if the PTE for virtual page VPAGE in PD lets the
+   user process write the page.  A copy-on-write page is not
+   writable until pagedir_break_cow() has been called for it.
+   Returns false if PD contains no PTE for VPAGE. */
+bool
+pagedir_is_writable (uint32_t *pd, const void *vpage) 
+{
+  uint32_t *pte = lookup_page (pd, vpage, false);
+  return pte != NULL && (*pte & PTE_W) != 0;
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
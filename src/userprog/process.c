@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "userprog/cow.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
@@ -18,11 +19,18 @@
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 
 static thread_func start_process NO_RETURN;
+static thread_func fork_process NO_RETURN;
+static bool process_copy_files (struct thread *, struct thread *);
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
-static void process_free_children (struct list *);
-static void process_close_all_open_files (struct list *);
+static void process_free_children (struct hash *);
+static hash_action_func process_free_child;
+static void process_close_all_open_files (struct thread *);
 
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
@@ -78,12 +86,13 @@ start_process (void *cmdline_copy_)
   if_.eflags = FLAG_IF | FLAG_MBS;
   success = load (cmdline_copy, &if_.eip, &if_.esp);
 
-  struct thread_child *child = thread_get_child (&cur->parent->children, cur->tid);
-  /* If thread has a parent, then parent was waiting for child to load. */
-  if(child != NULL)
+  /* Tell an exec() waiting in the parent whether we loaded. 
+     A failed load leaves exit_status at -1 for wait(). */
+  struct thread_child *child = cur->child_record;
+  if (child != NULL)
   {
     child->load_success = success;
-    sema_up (&thread_current ()->load_sema);
+    sema_up (&child->load_sema);
   }
 
   /* If load failed, quit. */
@@ -101,6 +110,134 @@ start_process (void *cmdline_copy_)
   NOT_REACHED ();
 }
 
+/* Passed from process_fork() to the child's fork_process(). */
+struct fork_info
+  {
+    struct thread *parent;      /* Process being forked. */
+    struct intr_frame if_;      /* Parent's user context. */
+    struct semaphore done;      /* Upped when the child is set up. */
+    bool success;               /* Did the child copy everything? */
+  };
+
+/* Creates a copy of the running process that resumes user mode
+   with the registers in F, as if returning from the same system
+   call, but with EAX set to 0.  The copy shares the parent's
+   memory copy-on-write and has its own open file for each of the
+   parent's.  Returns the child's thread id, or TID_ERROR if the
+   copy cannot be made.  Unlike process_execute(), does not return
+   until the child is ready to run. */
+tid_t
+process_fork (struct intr_frame *f) 
+{
+  struct thread *cur = thread_current ();
+  struct fork_info info;
+  tid_t tid;
+
+  info.parent = cur;
+  info.if_ = *f;
+  sema_init (&info.done, 0);
+  info.success = false;
+
+  tid = thread_create (cur->name, PRI_DEFAULT, fork_process, &info);
+  if (tid == TID_ERROR)
+    return TID_ERROR;
+
+  /* INFO lives on our stack, so wait until the child is done
+     with it.  This also keeps our pages from changing while the
+     child maps them. */
+  sema_down (&info.done);
+  if (!info.success)
+  {
+    process_forget_child (tid);
+    return TID_ERROR;
+  }
+  return tid;
+}
+
+/* A thread function that copies the process forked by
+   process_fork() and starts the copy running. */
+static void
+fork_process (void *info_)
+{
+  struct thread *cur = thread_current ();
+  struct fork_info *info = info_;
+  struct thread *parent = info->parent;
+  struct intr_frame if_ = info->if_;
+  bool success = false;
+
+  cur->pagedir = pagedir_create ();
+#ifdef VM
+  /* Keep the parent's pages where they are while we copy its
+     page directory and page table: if one were evicted between
+     the two copies, we would have neither the frame nor the swap
+     slot. */
+  lock_acquire (&parent->page_lock);
+  if (cur->pagedir != NULL
+      && pagedir_copy_cow (cur->pagedir, parent->pagedir)
+      && (cur->pages = page_table_create ()) != NULL
+      && page_table_copy (cur->pages, parent->pages))
+    success = true;
+  lock_release (&parent->page_lock);
+  success = (success && process_copy_files (cur, parent)
+             && mmap_copy (cur, parent));
+#else
+  if (cur->pagedir != NULL
+      && pagedir_copy_cow (cur->pagedir, parent->pagedir)
+      && process_copy_files (cur, parent))
+    success = true;
+#endif
+
+  /* A failed fork leaves exit_status at -1 for wait(). */
+  info->success = success;
+  sema_up (&info->done);
+  if (!success)
+    thread_exit ();
+
+  /* Return to user mode the way start_process() does. */
+  process_activate ();
+  if_.eax = 0;
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+
+/* Gives CHILD its own open file for the executable and for each
+   open descriptor in PARENT, at the same position.  Returns true
+   if successful, false if out of memory; whatever was opened is
+   closed again when CHILD exits. */
+static bool
+process_copy_files (struct thread *child, struct thread *parent)
+{
+  if (parent->executable_file != NULL)
+  {
+    child->executable_file = file_reopen (parent->executable_file);
+    if (child->executable_file == NULL)
+      return false;
+    file_deny_write (child->executable_file);
+  }
+
+  if (parent->fd_table_size == 0)
+    return true;
+
+  child->fd_table = calloc (parent->fd_table_size, sizeof *child->fd_table);
+  if (child->fd_table == NULL)
+    return false;
+  child->fd_table_size = parent->fd_table_size;
+  child->fd_free_hint = parent->fd_free_hint;
+
+  for (int fd = FD_FIRST; fd < parent->fd_table_size; fd++)
+  {
+    struct file *file = parent->fd_table[fd];
+    if (file == NULL)
+      continue;
+
+    child->fd_table[fd] = file_reopen (file);
+    if (child->fd_table[fd] == NULL)
+      return false;
+    file_seek (child->fd_table[fd], file_tell (file));
+  }
+  return true;
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -108,20 +245,68 @@ start_process (void *cmdline_copy_)
    been successfully called for the given TID, returns -1
    immediately, without waiting. */
 int
-process_wait (tid_t child_tid UNUSED) 
+process_wait (tid_t child_tid) 
 {
-  struct thread_child *c = thread_get_child (&thread_current ()->children, child_tid);
+  int status;
 
-  /* Cannot wait on the same child twice. */
-  if(c == NULL || c->has_been_waited_on)
+  if (child_tid == TID_ERROR
+      || process_waitpid (child_tid, &status, true) == TID_ERROR)
     return -1;
+  return status;
+}
 
-  c->has_been_waited_on = true;
-  /* Need to wait for child to finish executing. */
-  if(c->exit_status == STILL_ALIVE)
-    sema_down (&c->child_thread->exec_sema);
-  
-  return c->exit_status;
+/* Reaps child CHILD_TID, or any child if CHILD_TID is
+   TID_ERROR, once it has exited, storing its exit status in
+   *STATUS and returning its tid.  Any child reaps whichever child
+   exited first.  If BLOCK is false and no such child has exited
+   yet, returns 0 at once.  Returns TID_ERROR if there is no such
+   child that has not already been waited for. */
+tid_t
+process_waitpid (tid_t child_tid, int *status, bool block) 
+{
+  struct thread *cur = thread_current ();
+  struct thread_child *c = NULL;
+
+  if (child_tid != TID_ERROR)
+  {
+    c = thread_get_child (&cur->children, child_tid);
+    if (c == NULL)
+      return TID_ERROR;
+  }
+  else if (hash_empty (&cur->children))
+    return TID_ERROR;
+
+  /* Every child ups child_exit_sema once as it exits, after 
+     joining exited_children, so a child that exits between our 
+     look and our sleep still wakes us.  Ups left over from 
+     children reaped some other way just cost another look. */
+  struct thread_child *exited = NULL;
+  while (exited == NULL)
+  {
+    enum intr_level old_level = intr_disable ();
+    if (c != NULL)
+      exited = c->has_exited ? c : NULL;
+    else if (!list_empty (&cur->exited_children))
+      exited = list_entry (list_front (&cur->exited_children),
+                           struct thread_child, exit_elem);
+    if (exited != NULL)
+      list_remove (&exited->exit_elem);
+    intr_set_level (old_level);
+
+    if (exited == NULL)
+    {
+      if (!block)
+        return 0;
+      sema_down (&cur->child_exit_sema);
+    }
+  }
+
+  /* Forget the child, so that waiting for it again fails. */
+  tid_t tid = exited->tid;
+  *status = exited->exit_status;
+  hash_delete (&cur->children, &exited->child_elem);
+  thread_release_child (exited);
+  return tid;
 }
 
 /* 
@@ -135,17 +320,40 @@ process_exit (void)
   struct thread *cur = thread_current ();
   uint32_t *pd;
   
-  /* Done executing, wake up parent. */
-  sema_up (&cur->exec_sema);
+#ifdef VM
+  /* Write back memory-mapped files while the pages are still
+     there. */
+  mmap_unmap_all ();
+#endif
 
   /* Clean up memory by freeing children and closing files. */
   process_free_children (&cur->children);
-  process_close_all_open_files (&cur->open_files);
+  process_close_all_open_files (cur);
   file_close (cur->executable_file);
-  cur->parent = NULL;
+
+  /* Done executing, wake up parent. */
+  if (cur->child_record != NULL)
+  {
+    struct thread_child *c = cur->child_record;
+    enum intr_level old_level = intr_disable ();
+    c->has_exited = true;
+    if (c->parent != NULL)
+    {
+      list_push_back (&c->parent->exited_children, &c->exit_elem);
+      sema_up (&c->parent->child_exit_sema);
+    }
+    intr_set_level (old_level);
+    thread_release_child (c);
+    cur->child_record = NULL;
+  }
 
   /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
+#ifdef VM
+  /* Keep the frame table from evicting our pages while we free
+     them. */
+  lock_acquire (&cur->page_lock);
+#endif
   pd = cur->pagedir;
   if (pd != NULL) 
     {
@@ -160,37 +368,66 @@ process_exit (void)
       pagedir_activate (NULL);
       pagedir_destroy (pd);
     }
+
+#ifdef VM
+  page_table_destroy (cur->pages);
+  cur->pages = NULL;
+  lock_release (&cur->page_lock);
+#endif
 }
 
-/* Free all children for a given process. */
+/* Forgets child CHILD_TID, which failed to start and is exiting
+   or has exited, so that no later wait() can reap a pid that
+   fork() or exec() never returned. */
+void
+process_forget_child (tid_t child_tid)
+{
+  struct thread *cur = thread_current ();
+  struct thread_child *c = thread_get_child (&cur->children, child_tid);
+
+  hash_delete (&cur->children, &c->child_elem);
+
+  /* Take C back off exited_children if it got there first, and
+     keep it from getting there otherwise. */
+  enum intr_level old_level = intr_disable ();
+  if (c->has_exited)
+    list_remove (&c->exit_elem);
+  c->parent = NULL;
+  intr_set_level (old_level);
+  thread_release_child (c);
+}
+
+/* Free all children for a given process.  Children that are 
+   still running keep their records until they exit. */
 static void
-process_free_children (struct list *child_list)
+process_free_children (struct hash *children)
 {
-  if (!list_empty (child_list))
-  {
-    struct list_elem *e;
-    for (e = list_begin (child_list); e != list_end (child_list); e = list_next (e))
-    {
-      struct thread_child *c = list_entry(e, struct thread_child, child_elem);
-      list_remove (e);
-    }
-  }
+  hash_destroy (children, process_free_child);
 }
 
-/* Close all opened files. */
+/* Drops the parent's reference to child record E. */
 static void
-process_close_all_open_files (struct list *open_files)
+process_free_child (struct hash_elem *e, void *aux UNUSED)
 {
-  if (!list_empty (open_files))
-  {
-    struct list_elem *e;
-    for (e = list_begin (open_files); e != list_end (open_files); e = list_next (e))
-    {
-      struct thread_open_file *tof = list_entry(e, struct thread_open_file, elem);
-      file_close (tof->file);
-      list_remove (e);
-    }
-  }
+  struct thread_child *c = hash_entry (e, struct thread_child, child_elem);
+
+  /* Keep a child that is still running from notifying us. */
+  enum intr_level old_level = intr_disable ();
+  c->parent = NULL;
+  intr_set_level (old_level);
+  thread_release_child (c);
+}
+
+/* Close all opened files and free the descriptor table. */
+static void
+process_close_all_open_files (struct thread *t)
+{
+  for (int fd = FD_FIRST; fd < t->fd_table_size; fd++)
+    file_close (t->fd_table[fd]);
+
+  free (t->fd_table);
+  t->fd_table = NULL;
+  t->fd_table_size = 0;
 }
 
 /* Sets up the CPU for running user code in the current
@@ -306,6 +543,13 @@ load (const char *cmdline_copy, void (**eip) (void), void **esp)
     goto done;
   process_activate ();
 
+#ifdef VM
+  /* Allocate supplemental page table. */
+  t->pages = page_table_create ();
+  if (t->pages == NULL)
+    goto done;
+#endif
+
   /* Open executable file. */
   file = filesys_open (executable_name);
   if (file == NULL) 
@@ -408,7 +652,10 @@ load (const char *cmdline_copy, void (**eip) (void), void **esp)
 
 /* load() helpers. */
 
+#ifndef VM
 static bool install_page (void *upage, void *kpage, bool writable);
+static bool install_zero_page (void *upage, bool writable);
+#endif
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -467,6 +714,10 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
    The pages initialized by this function must be writable by the
    user process if WRITABLE is true, read-only otherwise.
 
+   With VM, nothing is read here.  Each page is only recorded in
+   the supplemental page table, and page_in() reads it in when
+   the process first touches it.
+
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
 static bool
@@ -477,7 +728,6 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
-  file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
       /* Calculate how to fill this page.
@@ -486,27 +736,59 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
-      /* Get a page of memory. */
-      uint8_t *kpage = palloc_get_page (PAL_USER);
-      if (kpage == NULL)
+#ifdef VM
+      if (!page_add_file (upage, file_get_inode (file), ofs,
+                          page_read_bytes, writable))
         return false;
-
-      /* Load this page. */
-      if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
+#else
+      /* A page of nothing but zeros is mapped to the zero page
+         until the process writes it. */
+      if (page_read_bytes == 0)
         {
-          palloc_free_page (kpage);
-          return false; 
+          if (!install_zero_page (upage, writable))
+            return false;
         }
-      memset (kpage + page_read_bytes, 0, page_zero_bytes);
-
-      /* Add the page to the process's address space. */
-      if (!install_page (upage, kpage, writable)) 
+      else
         {
-          palloc_free_page (kpage);
-          return false; 
+          /* Another process running this executable may have this
+             page of text loaded already. */
+          uint8_t *kpage = NULL;
+          if (!writable)
+            kpage = cow_get_text (file_get_inode (file), ofs,
+                                  page_read_bytes, upage);
+
+          if (kpage == NULL)
+            {
+              /* Get a page of memory. */
+              kpage = palloc_get_page (PAL_USER);
+              if (kpage == NULL)
+                return false;
+
+              /* Load this page. */
+              if (file_read_at (file, kpage, page_read_bytes, ofs)
+                  != (int) page_read_bytes)
+                {
+                  palloc_free_page (kpage);
+                  return false; 
+                }
+              memset (kpage + page_read_bytes, 0, page_zero_bytes);
+
+              if (!writable)
+                kpage = cow_add_text (kpage, file_get_inode (file), ofs,
+                                      page_read_bytes, upage);
+            }
+
+          /* Add the page to the process's address space. */
+          if (!install_page (upage, kpage, writable)) 
+            {
+              cow_release (kpage, upage);
+              return false; 
+            }
         }
+#endif
 
       /* Advance. */
+      ofs += page_read_bytes;
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
       upage += PGSIZE;
@@ -519,90 +801,94 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 static bool
 setup_stack (void **esp, const char *cmdline_copy) 
 {
-  uint8_t *kpage;
   bool success = false;
 
-  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+#ifdef VM
+  success = page_add_stack (((uint8_t *) PHYS_BASE) - PGSIZE);
+#else
+  uint8_t *kpage = palloc_get_page (PAL_USER | PAL_ZERO);
   if (kpage != NULL) 
     {
       success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
-      if (success)
-      {
-        *esp = PHYS_BASE;
-        
-        /*
-          Setting up the stack inspired by the following resources:
-            - https://static1.squarespace.com/static/5b18aa0955b02c1de94e4412/t/5b85fad2f950b7b16b7a2ed6/1535507195196/Pintos+Guide          
-            - https://github.com/Waqee/Pintos-Project-2/blob/master/src/userprog/syscall.c
-        */
-        int num_of_cmd_args = 0;
-
-        /* Make a copy to tokenize. */
-        char *cmdline_count_tok = malloc (sizeof(char) * (strlen (cmdline_copy) + 1));
-        strlcpy (cmdline_count_tok, cmdline_copy, strlen (cmdline_copy) + 1);
-
-        /* Count number of args (argc). */
-        
-        char *token, *save_ptr;
-        for (token = strtok_r (cmdline_count_tok, " ", &save_ptr); token != NULL; token = strtok_r (NULL, " ", &save_ptr))
-        {
-          num_of_cmd_args++;
-        }
+      if (!success)
+        palloc_free_page (kpage);
+    }
+#endif
+  if (success)
+  {
+    *esp = PHYS_BASE;
+    
+    /*
+      Setting up the stack inspired by the following resources:
+        - https://static1.squarespace.com/static/5b18aa0955b02c1de94e4412/t/5b85fad2f950b7b16b7a2ed6/1535507195196/Pintos+Guide          
+        - https://github.com/Waqee/Pintos-Project-2/blob/master/src/userprog/syscall.c
+    */
+    int num_of_cmd_args = 0;
+
+    /* Make a copy to tokenize. */
+    char *cmdline_count_tok = malloc (sizeof(char) * (strlen (cmdline_copy) + 1));
+    strlcpy (cmdline_count_tok, cmdline_copy, strlen (cmdline_copy) + 1);
+
+    /* Count number of args (argc). */
+    
+    char *token, *save_ptr;
+    for (token = strtok_r (cmdline_count_tok, " ", &save_ptr); token != NULL; token = strtok_r (NULL, " ", &save_ptr))
+    {
+      num_of_cmd_args++;
+    }
 
-        /* Free malloc'd resources to avoid leakage. */
-        free (cmdline_count_tok);
+    /* Free malloc'd resources to avoid leakage. */
+    free (cmdline_count_tok);
 
-        /* Split command line arguments and push onto stack. */
-        int arg_index;
-        char *argv_stack_pointers[num_of_cmd_args];
-        for (arg_index = 0, token = strtok_r (cmdline_copy, " ", &save_ptr); token != NULL; arg_index++, token = strtok_r (NULL, " ", &save_ptr))
-        {
-          /* Account for null byte. */
-          int required_alloc = strlen (token) + 1;
+    /* Split command line arguments and push onto stack. */
+    int arg_index;
+    char *argv_stack_pointers[num_of_cmd_args];
+    for (arg_index = 0, token = strtok_r (cmdline_copy, " ", &save_ptr); token != NULL; arg_index++, token = strtok_r (NULL, " ", &save_ptr))
+    {
+      /* Account for null byte. */
+      int required_alloc = strlen (token) + 1;
 
-          *esp -= required_alloc;
-          memcpy (*esp, token, required_alloc);
-          argv_stack_pointers[arg_index]= *esp;
-        }
+      *esp -= required_alloc;
+      memcpy (*esp, token, required_alloc);
+      argv_stack_pointers[arg_index]= *esp;
+    }
 
-        /* Word align stack pointer for increased memory access efficiency. */
-        int word_align = (size_t)*esp % 4;
-        if (word_align != 0)
-        {
-          *esp -= word_align; 
-          memset (*esp, 0, word_align);
-        }
+    /* Word align stack pointer for increased memory access efficiency. */
+    int word_align = (size_t)*esp % 4;
+    if (word_align != 0)
+    {
+      *esp -= word_align; 
+      memset (*esp, 0, word_align);
+    }
 
-        /* Write last argument, consists of four bytes of zeros. */
-        *esp -= sizeof(int);
-        memset (*esp, 0, sizeof(int));
+    /* Write last argument, consists of four bytes of zeros. */
+    *esp -= sizeof(int);
+    memset (*esp, 0, sizeof(int));
 
-        /* Write addresses pointing to each of the arguments. */
-        for (arg_index = num_of_cmd_args - 1; arg_index >= 0 ; arg_index--)
-        {
-          *esp -= sizeof(char *);
-          memcpy(*esp, &argv_stack_pointers[arg_index], sizeof(char *));
-        }
+    /* Write addresses pointing to each of the arguments. */
+    for (arg_index = num_of_cmd_args - 1; arg_index >= 0 ; arg_index--)
+    {
+      *esp -= sizeof(char *);
+      memcpy(*esp, &argv_stack_pointers[arg_index], sizeof(char *));
+    }
 
-        /* Write the address of argv[0]. */
-        char **argv_zero = *esp; 
-        *esp -= sizeof(char **);
-        memcpy(*esp, &argv_zero, sizeof(char **));
+    /* Write the address of argv[0]. */
+    char **argv_zero = *esp; 
+    *esp -= sizeof(char **);
+    memcpy(*esp, &argv_zero, sizeof(char **));
 
-        /* Write the number of command line arguments. */
-        *esp -= sizeof(int);
-        memcpy(*esp, &num_of_cmd_args, sizeof(int));
+    /* Write the number of command line arguments. */
+    *esp -= sizeof(int);
+    memcpy(*esp, &num_of_cmd_args, sizeof(int));
 
-        /* Write a fake return address. */
-        *esp -= sizeof(void *);
-        memset (*esp, 0, sizeof(void *));
-      }
-      else
-        palloc_free_page (kpage);
-    }
+    /* Write a fake return address. */
+    *esp -= sizeof(void *);
+    memset (*esp, 0, sizeof(void *));
+  }
   return success;
 }
 
+#ifndef VM
 /* Adds a mapping from user virtual address UPAGE to kernel
    virtual address KPAGE to the page table.
    If WRITABLE is true, the user process may modify the page;
@@ -622,3 +908,19 @@ install_page (void *upage, void *kpage, bool writable)
   return (pagedir_get_page (t->pagedir, upage) == NULL
           && pagedir_set_page (t->pagedir, upage, kpage, writable));
 }
+
+/* Maps user virtual address UPAGE to the shared zero page, as a
+   page of zeros that becomes a frame of its own on first write
+   if WRITABLE is true.
+   UPAGE must not already be mapped.
+   Returns true on success, false if UPAGE is already mapped or
+   if memory allocation fails. */
+static bool
+install_zero_page (void *upage, bool writable)
+{
+  struct thread *t = thread_current ();
+
+  return (pagedir_get_page (t->pagedir, upage) == NULL
+          && pagedir_set_zero_page (t->pagedir, upage, writable));
+}
+#endif
@@ -1,10 +1,14 @@
 #ifndef USERPROG_PROCESS_H
 #define USERPROG_PROCESS_H
 
+#include "threads/interrupt.h"
 #include "threads/thread.h"
 
 tid_t process_execute (const char *cmdline);
+tid_t process_fork (struct intr_frame *);
 int process_wait (tid_t);
+tid_t process_waitpid (tid_t, int *status, bool block);
+void process_forget_child (tid_t);
 void process_exit (void);
 void process_activate (void);
 
@@ -1,153 +1,331 @@
 #include "userprog/syscall.h"
+#include <limits.h>
 #include <stdio.h>
 #include <syscall-nr.h>
 #include "devices/input.h"
+#include "devices/intq.h"
 #include "devices/shutdown.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "lib/user/syscall.h"
 #include "userprog/pagedir.h"
 #include "userprog/process.h"
+#include "userprog/uaccess.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 
-/* Lock for syscalls dealing with critical sections of files. */
-static struct lock file_lock;
+/* Most arguments taken by any syscall.  Also the number of 
+   arguments in a struct ring_sqe. */
+#define SYSCALL_MAX_ARGS 4
 
-/* Lock for syscalls dealing with reading/writing from system. */
-static struct lock sys_lock;
+/* A syscall handler.  Receives the syscall's arguments, already 
+   copied out of user memory, and returns the value for eax. */
+typedef uint32_t syscall_func (const uint32_t *args);
+
+static syscall_func sys_halt, sys_exit, sys_exec, sys_wait, sys_create,
+  sys_remove, sys_open, sys_filesize, sys_read, sys_write, sys_seek,
+  sys_tell, sys_close, sys_pread, sys_pwrite, sys_readv, sys_writev,
+  sys_ring_enter, sys_copy_file_range, sys_spawn, sys_spawn_many,
+  sys_fork, sys_waitpid, sys_fadvise;
+#ifdef VM
+static syscall_func sys_mmap, sys_munmap, sys_madvise;
+#endif
+
+/* Dispatch table entry. */
+struct syscall
+  {
+    syscall_func *func;         /* Handler. */
+    int argc;                   /* Number of 32-bit arguments. */
+  };
+
+/* Syscalls indexed by number from lib/syscall-nr.h.  Numbers 
+   without a handler kill the calling process. */
+static const struct syscall syscall_table[] =
+  {
+    [SYS_HALT]     = {sys_halt, 0},
+    [SYS_EXIT]     = {sys_exit, 1},
+    [SYS_EXEC]     = {sys_exec, 1},
+    [SYS_WAIT]     = {sys_wait, 1},
+    [SYS_CREATE]   = {sys_create, 2},
+    [SYS_REMOVE]   = {sys_remove, 1},
+    [SYS_OPEN]     = {sys_open, 1},
+    [SYS_FILESIZE] = {sys_filesize, 1},
+    [SYS_READ]     = {sys_read, 3},
+    [SYS_WRITE]    = {sys_write, 3},
+    [SYS_SEEK]     = {sys_seek, 2},
+    [SYS_TELL]     = {sys_tell, 1},
+    [SYS_CLOSE]    = {sys_close, 1},
+    [SYS_PREAD]    = {sys_pread, 4},
+    [SYS_PWRITE]   = {sys_pwrite, 4},
+    [SYS_READV]    = {sys_readv, 3},
+    [SYS_WRITEV]   = {sys_writev, 3},
+    [SYS_RING_ENTER] = {sys_ring_enter, 1},
+    [SYS_COPY_FILE_RANGE] = {sys_copy_file_range, 3},
+    [SYS_SPAWN]    = {sys_spawn, 1},
+    [SYS_SPAWN_MANY] = {sys_spawn_many, 3},
+    [SYS_FORK]     = {sys_fork, 0},
+    [SYS_WAITPID]  = {sys_waitpid, 3},
+    [SYS_FADVISE]  = {sys_fadvise, 4},
+#ifdef VM
+    [SYS_MMAP]     = {sys_mmap, 2},
+    [SYS_MUNMAP]   = {sys_munmap, 1},
+    [SYS_MADVISE]  = {sys_madvise, 3},
+#endif
+  };
 
 static void syscall_handler (struct intr_frame *);
-static struct thread_open_file *find_thread_open_file (int);
-static inline bool is_page_mapped (void *);
-static void check_valid_user_vaddr (const void *);
-static void check_valid_buffer (void *, unsigned);
+static const struct syscall *syscall_lookup (uint32_t);
+static pid_t spawn_cmd_line (char *, const char *);
+static bool copy_file_name (char *, const char *);
+static bool copy_iovec (struct iovec *, const struct iovec *, int, bool);
+static void release_iovec (const struct iovec *, int);
+static struct file *fd_lookup (int);
+static int fd_allocate (struct file *);
+static inline bool is_page_mapped (void *, bool);
+static void check_valid_user_vaddr (const void *, bool);
+static void check_valid_buffer (void *, unsigned, bool);
+static void release_buffer (void *, unsigned);
 
 void
 syscall_init (void) 
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
-  lock_init (&file_lock);
-  lock_init (&sys_lock);
 }
 
 static void
-syscall_handler (struct intr_frame *f UNUSED) 
+syscall_handler (struct intr_frame *f) 
 {
-  check_valid_user_vaddr ((void *)((int *)f->esp + 1));
   /*
-    Acts on various syscalls. Calls appropriate function. Extracts and passes args.
-    If function returns anything, value is stored in eax register.
+    Looks up the syscall in the dispatch table, copies all of its 
+    arguments off the user stack at once, and calls its handler. 
+    The handler's return value is stored in eax register.
   */
-  int sys_code = *(int *)f->esp;
+  uint32_t sys_code;
+  uint32_t args[SYSCALL_MAX_ARGS];
 
-  switch (sys_code)
-  {
-    case SYS_HALT:
-    {
-      halt ();
-      break;
-    }
-    case SYS_EXIT:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      int status = *((int *)f->esp + 1);
-      exit (status);
-      break;
-    }
-    case SYS_EXEC:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      void *cmd_line = (void *)(*((int*)f->esp + 1));
-      check_valid_buffer (cmd_line, sizeof(cmd_line));
-      f->eax = exec((const char *)cmd_line);
-      break;
-    }
-    case SYS_WAIT:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      int p_id = *((int *)f->esp + 1);
-      f->eax = wait(p_id);
-      break;
-    }
-    case SYS_CREATE:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 3);
-      void *file = (void *)(*((int*)f->esp + 1));
-      unsigned initial_size = *((unsigned *)f->esp + 2);
-      f->eax = create((const char *)file, initial_size);
-      break;
-    }
-    case SYS_REMOVE:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      void *file = (void *)(*((int*)f->esp + 1));
-      f->eax = remove(file);
-      break;
-    }
-    case SYS_OPEN:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      void *file = (void *)(*((int*)f->esp + 1));
-      f->eax = open((const char *)file);
-      break;
-    }
-    case SYS_FILESIZE:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      int fd = *((int *)f->esp + 1);
-      f->eax = filesize(fd);
-      break;
-    }
-    case SYS_READ:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 4);
-      int fd = *((int *)f->esp + 1);
-      void *buffer = (void *)(*((int*)f->esp + 2));
-      unsigned size = *((unsigned *)f->esp + 3);
-      check_valid_buffer (buffer, size);
-      f->eax = read (fd, buffer, size);
-      break;
-    }
-    case SYS_WRITE:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 4);
-      int fd = *((int *)f->esp + 1);
-      void *buffer = (void *)(*((int*)f->esp + 2));
-      unsigned size = *((unsigned *)f->esp + 3);
-      check_valid_buffer (buffer, size);
-      f->eax = write(fd, buffer, size);
-      break;
-    }
-    case SYS_SEEK:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 3);
-      int fd = *((int *)f->esp + 1);
-      unsigned position = *((unsigned *)f->esp + 2);
-      seek(fd, position);
-      break;
-    }
-    case SYS_TELL:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      int fd = *((int *)f->esp + 1);
-      f->eax = tell(fd);
-      break;
-    }
-    case SYS_CLOSE:
-    {
-      check_valid_user_vaddr ((int *)f->esp + 2);
-      int fd = *((int *)f->esp + 1);
-      close(fd);
-      break;
-    }
-  }
+  if (!copy_from_user (&sys_code, f->esp, sizeof sys_code))
+    exit (-1);
+
+  const struct syscall *sc = syscall_lookup (sys_code);
+  if (sc == NULL)
+    exit (-1);
+
+  if (!copy_from_user (args, (uint32_t *)f->esp + 1, sc->argc * sizeof *args))
+    exit (-1);
+
+  thread_current ()->syscall_frame = f;
+  f->eax = sc->func (args);
+}
+
+/* Returns the dispatch table entry for syscall number sys_code, 
+   or NULL if there is no such syscall. */
+static const struct syscall *
+syscall_lookup (uint32_t sys_code)
+{
+  if (sys_code >= sizeof syscall_table / sizeof *syscall_table
+      || syscall_table[sys_code].func == NULL)
+    return NULL;
+
+  return &syscall_table[sys_code];
+}
+
+/* Handlers for the dispatch table.  Each unpacks its arguments 
+   from args, checks any buffers, and calls the function of the 
+   same name below. */
+
+static uint32_t
+sys_halt (const uint32_t *args UNUSED)
+{
+  halt ();
+}
+
+static uint32_t
+sys_exit (const uint32_t *args)
+{
+  exit ((int)args[0]);
+}
+
+static uint32_t
+sys_exec (const uint32_t *args)
+{
+  return exec ((const char *)args[0]);
+}
+
+static uint32_t
+sys_wait (const uint32_t *args)
+{
+  return wait ((pid_t)args[0]);
+}
+
+static uint32_t
+sys_create (const uint32_t *args)
+{
+  return create ((const char *)args[0], (unsigned)args[1]);
+}
+
+static uint32_t
+sys_remove (const uint32_t *args)
+{
+  return remove ((const char *)args[0]);
 }
 
+static uint32_t
+sys_open (const uint32_t *args)
+{
+  return open ((const char *)args[0]);
+}
+
+static uint32_t
+sys_filesize (const uint32_t *args)
+{
+  return filesize ((int)args[0]);
+}
+
+static uint32_t
+sys_read (const uint32_t *args)
+{
+  check_valid_buffer ((void *)args[1], (unsigned)args[2], true);
+  int bytes_read = read ((int)args[0], (void *)args[1], (unsigned)args[2]);
+  release_buffer ((void *)args[1], (unsigned)args[2]);
+  return bytes_read;
+}
+
+static uint32_t
+sys_write (const uint32_t *args)
+{
+  check_valid_buffer ((void *)args[1], (unsigned)args[2], false);
+  int bytes_written = write ((int)args[0], (const void *)args[1],
+                             (unsigned)args[2]);
+  release_buffer ((void *)args[1], (unsigned)args[2]);
+  return bytes_written;
+}
+
+static uint32_t
+sys_seek (const uint32_t *args)
+{
+  seek ((int)args[0], (unsigned)args[1]);
+  return 0;
+}
+
+static uint32_t
+sys_tell (const uint32_t *args)
+{
+  return tell ((int)args[0]);
+}
+
+static uint32_t
+sys_close (const uint32_t *args)
+{
+  close ((int)args[0]);
+  return 0;
+}
+
+static uint32_t
+sys_pread (const uint32_t *args)
+{
+  check_valid_buffer ((void *)args[1], (unsigned)args[2], true);
+  int bytes_read = pread ((int)args[0], (void *)args[1], (unsigned)args[2],
+                          (unsigned)args[3]);
+  release_buffer ((void *)args[1], (unsigned)args[2]);
+  return bytes_read;
+}
+
+static uint32_t
+sys_pwrite (const uint32_t *args)
+{
+  check_valid_buffer ((void *)args[1], (unsigned)args[2], false);
+  int bytes_written = pwrite ((int)args[0], (const void *)args[1],
+                              (unsigned)args[2], (unsigned)args[3]);
+  release_buffer ((void *)args[1], (unsigned)args[2]);
+  return bytes_written;
+}
+
+static uint32_t
+sys_readv (const uint32_t *args)
+{
+  return readv ((int)args[0], (const struct iovec *)args[1], (int)args[2]);
+}
+
+static uint32_t
+sys_writev (const uint32_t *args)
+{
+  return writev ((int)args[0], (const struct iovec *)args[1], (int)args[2]);
+}
+
+static uint32_t
+sys_ring_enter (const uint32_t *args)
+{
+  return ring_enter ((struct ring *)args[0]);
+}
+
+static uint32_t
+sys_copy_file_range (const uint32_t *args)
+{
+  return copy_file_range ((int)args[0], (int)args[1], (unsigned)args[2]);
+}
+
+static uint32_t
+sys_spawn (const uint32_t *args)
+{
+  return spawn ((const char *)args[0]);
+}
+
+static uint32_t
+sys_spawn_many (const uint32_t *args)
+{
+  return spawn_many ((const char **)args[0], (pid_t *)args[1], (unsigned)args[2]);
+}
+
+static uint32_t
+sys_fork (const uint32_t *args UNUSED)
+{
+  return fork ();
+}
+
+static uint32_t
+sys_waitpid (const uint32_t *args)
+{
+  return waitpid ((pid_t)args[0], (int *)args[1], (int)args[2]);
+}
+
+static uint32_t
+sys_fadvise (const uint32_t *args)
+{
+  return fadvise ((int)args[0], (unsigned)args[1], (unsigned)args[2],
+                  (int)args[3]);
+}
+
+#ifdef VM
+static uint32_t
+sys_mmap (const uint32_t *args)
+{
+  return mmap ((int)args[0], (void *)args[1]);
+}
+
+static uint32_t
+sys_munmap (const uint32_t *args)
+{
+  munmap ((mapid_t)args[0]);
+  return 0;
+}
+
+static uint32_t
+sys_madvise (const uint32_t *args)
+{
+  return madvise ((void *)args[0], (unsigned)args[1], (int)args[2]);
+}
+#endif
+
 /* Terminates Pintos by calling shutdown_power_off() 
    (declared in threads/init.h). This should be seldom 
    used, because you lose some information about possible 
@@ -176,11 +354,9 @@ exit (int status)
   /* Print error status for tests. */
   printf ("%s: exit(%d)\n", cur->name, status);
 
-  /* Grab the thread_child from parents children list. */
-  struct thread_child *c = thread_get_child (&cur->parent->children, cur->tid);
-
-  /* About to exit, update status. */
-  c->exit_status = status;
+  /* About to exit, update status for the parent. */
+  if (cur->child_record != NULL)
+    cur->child_record->exit_status = status;
 
   thread_exit();
 }
@@ -196,24 +372,92 @@ exit (int status)
 pid_t
 exec (const char *cmd_line)
 {
-  struct thread *parent = thread_current();
-
-  /* Execute the new process. */
-  pid_t pid = process_execute(cmd_line);
-
-  /* Get the child thread after it has either completely or partially executed. */
-  struct thread_child *c = thread_get_child(&parent->children, pid);
+  pid_t pid = spawn (cmd_line);
+  if (pid == -1)
+    return -1;
 
   /* Put parent to sleep while child attempts to load. */
-  sema_down(&c->child_thread->load_sema);
+  struct thread_child *c = thread_get_child (&thread_current ()->children, pid);
+  sema_down (&c->load_sema);
 
   /* Return -1 if child did not load correctly. Otherwise, just return PID from execution. */
-  if(!c->load_success)
+  if (!c->load_success)
+  {
+    process_forget_child (pid);
     return -1;
+  }
 
   return pid;
 }
 
+/* Like exec(), but returns the new process's pid without 
+   waiting for it to load, so the caller keeps running while 
+   the executable is read in.  If the load fails, the child 
+   exits and wait() on its pid returns -1.  Returns -1 only if 
+   the process could not be created at all. */
+pid_t
+spawn (const char *cmd_line)
+{
+  char *page = palloc_get_page (0);
+  if (page == NULL)
+    return -1;
+
+  pid_t pid = spawn_cmd_line (page, cmd_line);
+  palloc_free_page (page);
+  return pid;
+}
+
+/* Starts cnt processes, as if by spawn(), running the command 
+   lines in the array cmd_lines, and stores their pids in the 
+   array pids.  A process that cannot be created gets pid -1. 
+   Returns the number of processes created. */
+int
+spawn_many (const char **cmd_lines, pid_t *pids, unsigned cnt)
+{
+  char *page = palloc_get_page (0);
+  if (page == NULL)
+    return 0;
+
+  int started = 0;
+  for (unsigned i = 0; i < cnt; i++)
+  {
+    const char *cmd_line;
+    if (!copy_from_user (&cmd_line, cmd_lines + i, sizeof cmd_line))
+    {
+      palloc_free_page (page);
+      exit (-1);
+    }
+
+    pid_t pid = spawn_cmd_line (page, cmd_line);
+    if (!copy_to_user (pids + i, &pid, sizeof pid))
+    {
+      palloc_free_page (page);
+      exit (-1);
+    }
+    if (pid != -1)
+      started++;
+  }
+
+  palloc_free_page (page);
+  return started;
+}
+
+/* Creates a copy of the calling process, which returns from 
+   fork() with 0, while the caller gets the copy's pid.  The two 
+   share memory copy-on-write, so the copy is cheap until either 
+   writes.  Each open file is duplicated rather than shared, so 
+   the processes seek independently, and so is each memory 
+   mapping, so each process writes back its own changes.  Returns -1 if the copy 
+   cannot be made. */
+pid_t
+fork (void)
+{
+  tid_t tid = process_fork (thread_current ()->syscall_frame);
+  if (tid == TID_ERROR)
+    return -1;
+  return tid;
+}
+
 /*
   Waits for a child process pid and retrieves the child’s exit status.
 
@@ -235,6 +479,26 @@ wait (pid_t pid)
   return process_wait (pid);
 }
 
+/* Like wait(), but pid -1 waits for whichever child exits 
+   first, and with WNOHANG in options returns 0 instead of 
+   waiting if no child is ready.  Stores the child's exit status 
+   in *status unless status is a null pointer, and returns its 
+   pid.  Returns -1 if there is no such child left to wait for. */
+pid_t
+waitpid (pid_t pid, int *status, int options)
+{
+  if ((options & ~WNOHANG) != 0 || pid == 0 || pid < -1)
+    return -1;
+
+  int exit_status;
+  tid_t tid = process_waitpid (pid == -1 ? TID_ERROR : pid, &exit_status,
+                               (options & WNOHANG) == 0);
+  if (tid > 0 && status != NULL
+      && !copy_to_user (status, &exit_status, sizeof exit_status))
+    exit (-1);
+  return tid;
+}
+
 /* Creates a new file called file initially initial_size bytes in size. 
    Returns true if successful, false otherwise. Creating a new file does 
    not open it: opening the new file is a separate operation which would 
@@ -242,16 +506,12 @@ wait (pid_t pid)
 bool
 create (const char *file, unsigned initial_size)
 {
-  if (file == NULL || pagedir_get_page (thread_current ()->pagedir, file) == NULL)
-    exit (-1);
+  char name[NAME_MAX + 2];
 
-  lock_acquire(&file_lock);
+  if (!copy_file_name (name, file))
+    return false;
 
-    bool create_successful = filesys_create(file, initial_size);
-
-  lock_release(&file_lock);
-
-  return create_successful;
+  return filesys_create (name, initial_size);
 }
 
 /* Deletes the file called file. Returns true if successful, 
@@ -260,13 +520,12 @@ create (const char *file, unsigned initial_size)
 bool
 remove (const char *file)
 {
-  lock_acquire(&file_lock);
-
-    bool remove_successful = filesys_remove(file);
+  char name[NAME_MAX + 2];
 
-  lock_release(&file_lock);
+  if (!copy_file_name (name, file))
+    return false;
 
-  return remove_successful;
+  return filesys_remove (name);
 }
 
 /* Opens the file called file. Returns a nonnegative 
@@ -275,53 +534,40 @@ remove (const char *file)
 int
 open (const char *file)
 {
-  if (file == NULL || pagedir_get_page (thread_current ()->pagedir, file) == NULL)
-    exit (-1);
+  char name[NAME_MAX + 2];
 
-  lock_acquire (&file_lock);
-  struct file *f = filesys_open (file);
+  if (!copy_file_name (name, file))
+    return -1;
 
+  struct file *f = filesys_open (name);
   if (f == NULL)
-  {
-    lock_release (&file_lock);
     return -1;
-  }
-  else
-  {
-    int cur_fd = thread_current ()->fd_counter;
-    struct thread_open_file *new_file = malloc (sizeof(struct thread_open_file));
-    new_file->fd = cur_fd;
-    new_file->file = f;
-    list_push_back(&thread_current ()->open_files, &new_file->elem);
-    thread_current ()->fd_counter += 1;
-
-    lock_release (&file_lock);
-    return cur_fd;
-  }
+
+  int fd = fd_allocate (f);
+  if (fd == -1)
+    file_close (f);
+
+  return fd;
 }
 
 /* Returns the size, in bytes, of the file open as fd. */
 int
 filesize (int fd)
 {
-  lock_acquire (&file_lock);
-
-    struct thread_open_file *tof = find_thread_open_file (fd);
-    if (tof == NULL)
-      return -1;
-    struct file *f = tof->file;
-    int file_size = file_length (f);
-  
-  lock_release (&file_lock);
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    return -1;
 
-  return file_size;
+  return file_length (f);
 }
 
 /* Reads size bytes from the file open as fd into buffer. 
    Returns the number of bytes actually read (0 at end of 
    file), or -1 if the file could not be read (due to a 
    condition other than end of file). Fd 0 reads from the 
-   keyboard using input_getc(). */
+   keyboard using input_read(), which waits only for the first 
+   key; after that the read returns whatever keys are already 
+   buffered, up to the end of the line, so it may be short. */
 int
 read (int fd, void *buffer, unsigned size)
 {
@@ -329,33 +575,28 @@ read (int fd, void *buffer, unsigned size)
   if (fd == STDOUT_FILENO)
     return 0;
 
-  /* Read from STDIN. */
+  /* Read from STDIN.  The keys go through a kernel buffer because 
+     input_read() runs with interrupts off, where touching user 
+     memory is not safe. */
   if (fd == STDIN_FILENO)
   {
-    lock_acquire (&sys_lock);
+    uint8_t keys[INTQ_BUFSIZE];
 
-      uint8_t *buff_ptr = (uint8_t *)buffer;
-      for(unsigned i = 0; i < size; i++)
-      {
-        buff_ptr[i] = input_getc();
-      }
+    if (size == 0)
+      return 0;
 
-    lock_release (&sys_lock);
+    size_t cnt = input_read (keys, size < sizeof keys ? size : sizeof keys);
+    if (!copy_to_user (buffer, keys, cnt))
+      exit (-1);
 
-		return size;
+    return cnt;
   }
 
-  lock_acquire (&file_lock);
-
-    struct thread_open_file *tof = find_thread_open_file (fd);
-    if (tof == NULL)
-      exit (-1);
-    struct file *f = tof->file;
-    int bytes_read = file_read (f, buffer, size);
-  
-  lock_release (&file_lock);
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    exit (-1);
 
-  return bytes_read;
+  return file_read (f, buffer, size);
 }
 
 /* Writes size bytes from buffer to the open file fd. 
@@ -376,17 +617,11 @@ write (int fd, const void *buffer, unsigned size)
     return size;
   }
   
-  lock_acquire (&file_lock);
-
-    struct thread_open_file *tof = find_thread_open_file (fd);
-    if (tof == NULL)
-      exit (-1);
-    
-    int bytes_written = 0;
-    bytes_written = (int)file_write (tof->file, buffer, (off_t)size);
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    exit (-1);
 
-  lock_release (&file_lock);
-  return bytes_written;
+  return file_write (f, buffer, size);
 }
 
 /* Changes the next byte to be read or written in open file 
@@ -395,14 +630,9 @@ write (int fd, const void *buffer, unsigned size)
 void
 seek (int fd, unsigned position)
 {
-  lock_acquire (&file_lock);
-  struct thread_open_file *tof = find_thread_open_file (fd);
-  if (tof != NULL)
-  {
-    struct file *f = tof->file;
+  struct file *f = fd_lookup (fd);
+  if (f != NULL)
     file_seek (f, position);
-  }
-  lock_release (&file_lock);
 }
 
 /* Returns the position of the next byte to be read 
@@ -411,18 +641,11 @@ seek (int fd, unsigned position)
 unsigned
 tell (int fd)
 {
-  lock_acquire (&file_lock);
-  struct thread_open_file *tof = find_thread_open_file (fd);
-  if (tof != NULL)
-  {
-    struct file *f = tof->file;
-    unsigned position = file_tell (f);
-    lock_release (&file_lock);
-    return position;
-  }
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    return -1;
 
-  lock_release (&file_lock);
-  return -1;
+  return file_tell (f);
 }
 
 /* Closes file descriptor fd. Exiting or terminating a 
@@ -431,69 +654,517 @@ tell (int fd)
 void
 close (int fd)
 {
-  lock_acquire (&file_lock);
+  struct thread *cur = thread_current ();
+  struct file *f = fd_lookup (fd);
+  if (f != NULL)
+  {
+    file_close (f);
+    cur->fd_table[fd] = NULL;
+    if (fd < cur->fd_free_hint)
+      cur->fd_free_hint = fd;
+  }
+}
+
+/* Reads size bytes from the file open as fd into buffer, 
+   starting at byte position in the file instead of at the 
+   current position, which is left unchanged.  Saves the seek 
+   that read() would need for random access.  Returns the number 
+   of bytes actually read (0 at or past end of file), or -1 if 
+   fd is the console or position is out of range. */
+int
+pread (int fd, void *buffer, unsigned size, unsigned position)
+{
+  if (fd == STDIN_FILENO || fd == STDOUT_FILENO)
+    return -1;
+
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    exit (-1);
+
+  if ((off_t)position < 0)
+    return -1;
+
+  return file_read_at (f, buffer, size, position);
+}
+
+/* Writes size bytes from buffer to the open file fd, starting 
+   at byte position in the file instead of at the current 
+   position, which is left unchanged.  Returns the number of 
+   bytes actually written, or -1 if fd is the console or 
+   position is out of range. */
+int
+pwrite (int fd, const void *buffer, unsigned size, unsigned position)
+{
+  if (fd == STDIN_FILENO || fd == STDOUT_FILENO)
+    return -1;
+
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    exit (-1);
+
+  if ((off_t)position < 0)
+    return -1;
+
+  return file_write_at (f, buffer, size, position);
+}
+
+/* Reads from the file open as fd into the iovcnt buffers 
+   described by iov, filling each one before moving on to the 
+   next.  Returns the number of bytes actually read (0 at end of 
+   file), or -1 if iovcnt is negative or more than IOV_MAX or 
+   the buffers add up to more than INT_MAX bytes. */
+int
+readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct iovec kiov[IOV_MAX];
+  int bytes_read = 0;
+
+  if (!copy_iovec (kiov, iov, iovcnt, true))
+    return -1;
 
-  struct thread_open_file *tof = find_thread_open_file (fd);
-  if (tof != NULL)
+  /* Cannot read from STDOUT. */
+  if (fd == STDOUT_FILENO)
+    ;
+
+  /* Read from STDIN.  A console read may be short, so only the 
+     first nonempty buffer is filled, to avoid waiting for more 
+     keys once some have arrived. */
+  else if (fd == STDIN_FILENO)
   {
-    file_close (tof->file);
-    list_remove (&tof->elem);
-    free (tof);
+    for (int i = 0; i < iovcnt; i++)
+      if (kiov[i].iov_len > 0)
+      {
+        bytes_read = read (fd, kiov[i].iov_base, kiov[i].iov_len);
+        break;
+      }
   }
-  
-  lock_release (&file_lock);
+
+  else
+  {
+    struct file *f = fd_lookup (fd);
+    if (f == NULL)
+      exit (-1);
+    bytes_read = file_readv (f, kiov, iovcnt);
+  }
+
+  release_iovec (kiov, iovcnt);
+  return bytes_read;
+}
+
+/* Writes the iovcnt buffers described by iov, in order, to the 
+   open file fd.  Returns the number of bytes actually written, 
+   or -1 if iovcnt is negative or more than IOV_MAX or the 
+   buffers add up to more than INT_MAX bytes. */
+int
+writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  struct iovec kiov[IOV_MAX];
+  int bytes_written = 0;
+
+  if (!copy_iovec (kiov, iov, iovcnt, false))
+    return -1;
+
+  /* Disallow write to STDIN. */
+  if (fd == STDIN_FILENO)
+    exit (-1);
+
+  /* Write to STDOUT. */
+  if (fd == STDOUT_FILENO)
+  {
+    for (int i = 0; i < iovcnt; i++)
+    {
+      putbuf ((const char *)kiov[i].iov_base, kiov[i].iov_len);
+      bytes_written += kiov[i].iov_len;
+    }
+  }
+
+  else
+  {
+    struct file *f = fd_lookup (fd);
+    if (f == NULL)
+      exit (-1);
+    bytes_written = file_writev (f, kiov, iovcnt);
+  }
+
+  release_iovec (kiov, iovcnt);
+  return bytes_written;
+}
+
+#ifdef VM
+/* Maps the file open as fd into the process's virtual address 
+   space, starting at addr, which must be page-aligned.  Pages 
+   of the file are read in as they are touched, not copied up 
+   front, and modified pages are written back when the mapping 
+   is removed by munmap() or at exit.  The mapping lasts even if 
+   fd is closed.  Returns an id for the mapping, or MAP_FAILED if 
+   fd is not an open file, the file is empty, or its pages would 
+   overlap any already in use. */
+mapid_t
+mmap (int fd, void *addr)
+{
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    return MAP_FAILED;
+
+  return mmap_map (f, addr);
+}
+
+/* Removes the mapping made by mmap() with id mapping from the 
+   calling process, writing back its modified pages. */
+void
+munmap (mapid_t mapping)
+{
+  mmap_unmap (mapping);
 }
 
-/* Finds an open file in the current threads open_files list. */
-static struct thread_open_file *
-find_thread_open_file (int fd)
+/* Tells the kernel how the length bytes of memory starting at 
+   addr, which must be page-aligned, will be used.  advice is 
+   ADV_NORMAL, ADV_RANDOM, or ADV_SEQUENTIAL to describe the 
+   pattern of later accesses, ADV_WILLNEED to start reading the 
+   pages in, or ADV_DONTNEED to give up their frames now; see 
+   page_advise().  Returns 0 if successful, or -1 if addr is not 
+   page-aligned, advice is not one of these, or the range 
+   includes memory that is not mapped. */
+int
+madvise (void *addr, unsigned length, int advice)
+{
+  if (pg_ofs (addr) != 0 || !is_user_vaddr (addr)
+      || length > (size_t)((uint8_t *)PHYS_BASE - (uint8_t *)addr)
+      || advice < ADV_NORMAL || advice > ADV_DONTNEED)
+    return -1;
+
+  return page_advise (addr, length, advice) ? 0 : -1;
+}
+#endif
+
+/* Tells the kernel how the file open as fd will be read.  advice 
+   is ADV_NORMAL, ADV_RANDOM, or ADV_SEQUENTIAL to size the 
+   read-ahead after each later read, or ADV_WILLNEED or 
+   ADV_DONTNEED to start reading the length bytes at offset into 
+   the buffer cache or let the cache drop them first; a length 
+   of 0 means the rest of the file.  See file_advise().  Returns 
+   0 if successful, or -1 if fd is not an open file, advice is 
+   not one of these, or offset or length is out of range. */
+int
+fadvise (int fd, unsigned offset, unsigned length, int advice)
+{
+  if ((off_t)offset < 0 || (off_t)length < 0
+      || advice < ADV_NORMAL || advice > ADV_DONTNEED)
+    return -1;
+
+  struct file *f = fd_lookup (fd);
+  if (f == NULL)
+    return -1;
+
+  file_advise (f, offset, length, advice);
+  return 0;
+}
+
+/* 
+  Runs the syscalls queued on ring's submission queue, in order, 
+  posting the result of each to its completion queue.  This lets 
+  a process pay for one trap into the kernel per batch of 
+  syscalls rather than per syscall.  Each queued syscall behaves 
+  just as if it had been made on its own, including killing the 
+  process for a bad pointer.  Unknown syscalls, ring_enter() 
+  itself, and fork(), whose child could not resume mid-batch, 
+  complete with result -1.
+
+  Stops early if the completion queue fills up.  Returns the 
+  number of submissions consumed, or -1 if the ring's indexes 
+  are inconsistent.
+*/
+int
+ring_enter (struct ring *ring)
+{
+  unsigned sq_head, sq_tail, cq_head, cq_tail;
+
+  /* Read the indexes once; only the kernel moves sq_head and 
+     cq_tail, and the process cannot run until we return. */
+  if (!copy_from_user (&sq_head, &ring->sq_head, sizeof sq_head)
+      || !copy_from_user (&sq_tail, &ring->sq_tail, sizeof sq_tail)
+      || !copy_from_user (&cq_head, &ring->cq_head, sizeof cq_head)
+      || !copy_from_user (&cq_tail, &ring->cq_tail, sizeof cq_tail))
+    exit (-1);
+
+  if (sq_tail - sq_head > RING_SIZE || cq_tail - cq_head > RING_SIZE)
+    return -1;
+
+  int submitted = 0;
+  while (sq_head != sq_tail && cq_tail - cq_head < RING_SIZE)
+  {
+    struct ring_sqe sqe;
+    struct ring_cqe cqe;
+
+    if (!copy_from_user (&sqe, &ring->sq[sq_head % RING_SIZE], sizeof sqe))
+      exit (-1);
+    sq_head++;
+
+    /* ring_enter() is left out so a batch cannot recurse. */
+    const struct syscall *sc = syscall_lookup (sqe.number);
+    cqe.user_data = sqe.user_data;
+    if (sc != NULL && sc->func != sys_ring_enter && sc->func != sys_fork)
+      cqe.result = sc->func (sqe.args);
+    else
+      cqe.result = -1;
+
+    if (!copy_to_user (&ring->cq[cq_tail % RING_SIZE], &cqe, sizeof cqe))
+      exit (-1);
+    cq_tail++;
+    submitted++;
+  }
+
+  if (!copy_to_user (&ring->sq_head, &sq_head, sizeof sq_head)
+      || !copy_to_user (&ring->cq_tail, &cq_tail, sizeof cq_tail))
+    exit (-1);
+
+  return submitted;
+}
+
+/* Copies length bytes from the file open as fd_in, starting at 
+   its current position, to the file open as fd_out at its 
+   current position, and advances both positions.  The data 
+   moves sector by sector inside the buffer cache and never 
+   enters user memory.  Returns the number of bytes actually 
+   copied, which may be less than length at end of either file, 
+   or -1 if either fd is the console, both are the same fd, or 
+   both are open on the same file and the two ranges overlap. */
+int
+copy_file_range (int fd_in, int fd_out, unsigned length)
+{
+  if (fd_in == STDIN_FILENO || fd_in == STDOUT_FILENO
+      || fd_out == STDIN_FILENO || fd_out == STDOUT_FILENO)
+    return -1;
+
+  struct file *in = fd_lookup (fd_in);
+  struct file *out = fd_lookup (fd_out);
+  if (in == NULL || out == NULL)
+    exit (-1);
+
+  if (in == out)
+    return -1;
+
+  if (length > INT_MAX)
+    length = INT_MAX;
+
+  /* Copying forward within one file would read bytes it has 
+     already overwritten. */
+  if (file_get_inode (in) == file_get_inode (out))
+  {
+    off_t in_pos = file_tell (in);
+    off_t out_pos = file_tell (out);
+    off_t gap = in_pos > out_pos ? in_pos - out_pos : out_pos - in_pos;
+    if ((unsigned) gap < length)
+      return -1;
+  }
+
+  return file_copy (out, in, length);
+}
+
+/* Copies the command line at user address ucmd_line into page, 
+   which must be PGSIZE bytes, and starts a process running it. 
+   Returns the new process's pid, or -1 if the command line is 
+   too long or the process could not be created.  If ucmd_line 
+   is not a valid string in user memory, frees page and exits 
+   with error status. */
+static pid_t
+spawn_cmd_line (char *page, const char *ucmd_line)
+{
+  int len = strncpy_from_user (page, ucmd_line, PGSIZE);
+  if (len == -1)
+  {
+    palloc_free_page (page);
+    exit (-1);
+  }
+  if (len == PGSIZE)
+    return -1;
+
+  tid_t tid = process_execute (page);
+  return tid == TID_ERROR ? -1 : tid;
+}
+
+/* Copies the file name at user address ufile into name, which 
+   must have room for NAME_MAX + 2 bytes.  Exits with error status 
+   if ufile is not a valid string in user memory.  Returns false, 
+   without exiting, if the name is too long to name any file. */
+static bool
+copy_file_name (char *name, const char *ufile)
+{
+  int len = strncpy_from_user (name, ufile, NAME_MAX + 2);
+  if (len == -1)
+    exit (-1);
+
+  return len <= NAME_MAX;
+}
+
+/* Copies the iovcnt-element array at user address uiov into 
+   kiov, which must have room for IOV_MAX elements, then checks 
+   every buffer it describes as check_valid_buffer() does, for 
+   writing if write is true.  Exits with error status if the 
+   array or any of the buffers is not valid user memory.  Returns 
+   false, without exiting or checking the buffers, if iovcnt is 
+   out of range or the buffers add up to more than INT_MAX bytes. 
+   Otherwise the caller must pass kiov to release_iovec() when 
+   done with the buffers. */
+static bool
+copy_iovec (struct iovec *kiov, const struct iovec *uiov, int iovcnt,
+            bool write)
+{
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return false;
+
+  if (!copy_from_user (kiov, uiov, iovcnt * sizeof *kiov))
+    exit (-1);
+
+  size_t total = 0;
+  for (int i = 0; i < iovcnt; i++)
+  {
+    if (kiov[i].iov_len > INT_MAX - total)
+      return false;
+    total += kiov[i].iov_len;
+  }
+
+  for (int i = 0; i < iovcnt; i++)
+    check_valid_buffer (kiov[i].iov_base, kiov[i].iov_len, write);
+  return true;
+}
+
+/* Releases the iovcnt buffers in kiov checked by copy_iovec(). */
+static void
+release_iovec (const struct iovec *kiov, int iovcnt)
+{
+  for (int i = 0; i < iovcnt; i++)
+    release_buffer (kiov[i].iov_base, kiov[i].iov_len);
+}
+
+/* Returns the file open as fd in the current thread, 
+   or NULL if fd is not open. */
+static struct file *
+fd_lookup (int fd)
+{
+  struct thread *cur = thread_current ();
+
+  if (fd < FD_FIRST || fd >= cur->fd_table_size)
+    return NULL;
+
+  return cur->fd_table[fd];
+}
+
+/* Installs f in the lowest free slot of the current thread's 
+   descriptor table, growing the table if there is no free slot. 
+   A new process has no table at all, and fd_free_hint may point 
+   past the end of the table.  Returns the new fd, or -1 if memory 
+   is exhausted. */
+static int
+fd_allocate (struct file *f)
 {
   struct thread *cur = thread_current ();
-  struct list_elem *e;
+  int fd;
+
+  for (fd = cur->fd_free_hint; fd < cur->fd_table_size; fd++)
+    if (cur->fd_table[fd] == NULL)
+      break;
 
-  for (e = list_begin (&cur->open_files); e != list_end (&cur->open_files); e = list_next (e))
+  if (fd >= cur->fd_table_size)
   {
-    struct thread_open_file *tof = list_entry (e, struct thread_open_file, elem);
+    int new_size = cur->fd_table_size == 0 ? 16 : cur->fd_table_size * 2;
+    while (new_size <= fd)
+      new_size *= 2;
+
+    struct file **new_table = realloc (cur->fd_table, new_size * sizeof *new_table);
+    if (new_table == NULL)
+      return -1;
 
-    if (tof->fd == fd)
-      return tof;
+    for (int i = cur->fd_table_size; i < new_size; i++)
+      new_table[i] = NULL;
+    cur->fd_table = new_table;
+    cur->fd_table_size = new_size;
   }
 
-  return NULL;
+  cur->fd_table[fd] = f;
+  cur->fd_free_hint = fd + 1;
+  return fd;
 }
 
-/* Checks if a virtual address is mapped to user memory. */
+/* Checks if a virtual address is mapped to user memory that 
+   the process may write, if write is true.  A copy-on-write page 
+   that is about to be written gets its private copy now.  With 
+   VM, a page that has not been touched yet is brought in, and a 
+   buffer on the stack at or above the stack pointer gets its 
+   stack page; either way the page is then pinned until 
+   release_buffer(), because the file system copies to and from 
+   user buffers while holding locks that page_in() would need. */
 static inline bool
-is_page_mapped (void *check_vaddr)
+is_page_mapped (void *check_vaddr, bool write)
 {
-  return pagedir_get_page (thread_current ()->pagedir, check_vaddr) == NULL ? false: true;
+  struct thread *cur = thread_current ();
+#ifdef VM
+  return (page_pin (check_vaddr, write)
+          || (page_grow_stack (check_vaddr, cur->syscall_frame->esp,
+                               false)
+              && page_pin (check_vaddr, write)));
+#else
+  void *upage = pg_round_down (check_vaddr);
+  return (pagedir_get_page (cur->pagedir, upage) != NULL
+          && (!write
+              || pagedir_is_writable (cur->pagedir, upage)
+              || pagedir_break_cow (cur->pagedir, upage)));
+#endif
 }
 
 /* Exits with error status if vaddr is invalid. */
 static void
-check_valid_user_vaddr (const void *check_vaddr)
+check_valid_user_vaddr (const void *check_vaddr, bool write)
 {
   if (check_vaddr == NULL                 || 
       check_vaddr < (void *)0x08048000    || 
       !is_user_vaddr (check_vaddr)        || 
-      !is_page_mapped(check_vaddr))
+      !is_page_mapped((void *)check_vaddr, write))
   {
     exit (-1);
   }
 }
 
 /* 
-  Ensures that entire buffer is valid in memory.
-  This function inspired by:
-   -https://github.com/ChristianJHughes/pintos-project2/blob/master/pintos/src/userprog/syscall.c
+  Ensures that entire buffer is valid in memory, and writable if 
+  write is true.  Every byte of a page is mapped if any byte of 
+  it is, so each page the buffer touches is checked once, at 
+  its first byte in the buffer.  This keeps the cost 
+  proportional to the number of pages in the buffer, not the 
+  number of bytes.  The caller must pass the buffer to 
+  release_buffer() when done with it.
 */
 static void
-check_valid_buffer (void *buffer, unsigned size)
+check_valid_buffer (void *buffer, unsigned size, bool write)
 {
-  char *buff_ptr = (char *)buffer;
-  for (unsigned i = 0; i < size; i++)
-  {
-    check_valid_user_vaddr (buff_ptr);
-    buff_ptr += 1;
-  }
-}
\ No newline at end of file
+  if (size == 0)
+    return;
+
+  char *start = (char *)buffer;
+  char *end = start + size - 1;
+  if (end < start)
+    exit (-1);
+
+  check_valid_user_vaddr (start, write);
+  for (char *page = (char *)pg_round_down (start) + PGSIZE; 
+       page > start && page <= end; page += PGSIZE)
+    check_valid_user_vaddr (page, write);
+}
+
+/* Releases a buffer checked by check_valid_buffer().  With VM, 
+   this unpins its pages. */
+static void
+release_buffer (void *buffer UNUSED, unsigned size UNUSED)
+{
+#ifdef VM
+  if (size == 0)
+    return;
+
+  char *start = (char *)buffer;
+  char *end = start + size - 1;
+  page_unpin (start);
+  for (char *page = (char *)pg_round_down (start) + PGSIZE; 
+       page > start && page <= end; page += PGSIZE)
+    page_unpin (page);
+#endif
+}
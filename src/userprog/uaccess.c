@@ -0,0 +1,105 @@
+#include "userprog/uaccess.h"
+#include <stdint.h>
+#include "threads/vaddr.h"
+
+/* The only instructions that touch user memory are in the two
+   assembly routines below, which lie between the labels
+   uaccess_start and uaccess_end.  Before touching user memory
+   each loads the address of a recovery label into EAX.  A page
+   fault taken in the kernel at an EIP in that range makes
+   page_fault() jump to the address in EAX with EAX set to -1, in
+   place of retrying the faulting instruction.  Any other kernel
+   fault on a user address is a kernel bug. */
+
+/* Copies SIZE bytes from SRC to DST, either of which may be a
+   user address.  Returns the number of bytes not copied, which
+   is nonzero only if a page fault cut the copy short. */
+size_t uaccess_copy (void *dst, const void *src, size_t size);
+
+/* Reads a byte at user virtual address UADDR, which must be
+   below PHYS_BASE.  Returns the byte value if successful, -1 if
+   a page fault occurred. */
+int uaccess_get_byte (const uint8_t *uaddr);
+
+asm (".text\n"
+     ".globl uaccess_start, uaccess_end\n"
+     ".globl uaccess_copy, uaccess_get_byte\n"
+     "uaccess_start:\n"
+     "uaccess_copy:\n"
+     "        pushl %esi\n"
+     "        pushl %edi\n"
+     "        movl 12(%esp), %edi\n"
+     "        movl 16(%esp), %esi\n"
+     "        movl 20(%esp), %ecx\n"
+     "        movl $1f, %eax\n"
+     "        rep movsb\n"
+     "1:      movl %ecx, %eax\n"
+     "        popl %edi\n"
+     "        popl %esi\n"
+     "        ret\n"
+     "uaccess_get_byte:\n"
+     "        movl 4(%esp), %edx\n"
+     "        movl $1f, %eax\n"
+     "        movzbl (%edx), %eax\n"
+     "1:      ret\n"
+     "uaccess_end:\n");
+
+/* Returns true if the SIZE bytes starting at UADDR all lie in
+   user virtual memory. */
+static bool
+is_user_range (const void *uaddr, size_t size)
+{
+  return (is_user_vaddr (uaddr)
+          && size <= (size_t) ((uint8_t *) PHYS_BASE - (uint8_t *) uaddr));
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if any part of the
+   source is not mapped user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  return is_user_range (usrc, size) && uaccess_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if any part of the
+   destination is not mapped user memory or may not be written.
+   CR0.WP is set, so the kernel's writes fault on read-only user
+   pages just as the process's own would: a copy-on-write page
+   gets its private copy in page_fault() and the copy goes on,
+   while a truly read-only page makes the copy fail. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  return is_user_range (udst, size) && uaccess_copy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   DST, which has room for SIZE bytes including the null
+   terminator.  Returns the length of the string, not counting
+   the null terminator, if successful.  Returns SIZE if the
+   string does not fit, in which case DST is not
+   null-terminated.  Returns -1 if the string is not in mapped
+   user memory. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  const uint8_t *p = (const uint8_t *) usrc;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      int c;
+
+      if (!is_user_vaddr (p + i))
+        return -1;
+      c = uaccess_get_byte (p + i);
+      if (c == -1)
+        return -1;
+      dst[i] = c;
+      if (c == '\0')
+        return i;
+    }
+  return size;
+}
@@ -0,0 +1,23 @@
+#ifndef USERPROG_UACCESS_H
+#define USERPROG_UACCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Copying data between the kernel and user memory.
+
+   These functions access user memory directly, without checking
+   the page tables first.  If the access faults, page_fault() in
+   userprog/exception.c resumes execution at a recovery point in
+   the function, which then reports failure.  The common case of
+   a valid user pointer therefore costs no more than a memcpy(). */
+
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+/* Bounds of the code in uaccess.c that may fault on a user
+   address, for page_fault(). */
+extern char uaccess_start[], uaccess_end[];
+
+#endif /* userprog/uaccess.h */
@@ -0,0 +1,299 @@
+#include "vm/frame.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/cow.h"
+#include "userprog/pagedir.h"
+#include "vm/page.h"
+
+/* A frame in the user pool. */
+struct frame
+  {
+    struct hash_elem hash_elem; /* Element in frames. */
+    struct list_elem list_elem; /* Element in clock. */
+    void *kpage;                /* Kernel virtual address. */
+    struct thread *owner;       /* Process mapping the frame, unless
+                                   cow.c says otherwise. */
+    void *upage;                /* User virtual address in OWNER. */
+    int pin_cnt;                /* Nonzero: may not be evicted. */
+  };
+
+/* All frames, keyed by kernel virtual address. */
+static struct hash frames;
+
+/* All frames, in the order the clock hand visits them. */
+static struct list clock;
+
+/* Next frame the clock hand will visit, or the list tail. */
+static struct list_elem *hand;
+
+/* Protects frames, clock, hand, and each frame's members.
+   Held across an eviction, including its swap I/O. */
+static struct lock frame_lock;
+
+static hash_hash_func frame_hash;
+static hash_less_func frame_less;
+static struct frame *lookup (void *kpage);
+static struct frame *evict (void);
+
+/* Initializes the frame table. */
+void
+frame_init (void) 
+{
+  hash_init (&frames, frame_hash, frame_less, NULL);
+  list_init (&clock);
+  hand = list_end (&clock);
+  lock_init (&frame_lock);
+}
+
+/* Obtains a frame from the user pool for user page UPAGE in the
+   running process, evicting some other page if the pool is
+   empty, and returns its kernel virtual address.  FLAGS is as
+   for palloc_get_page(); PAL_USER is implied.  The caller should
+   map the frame at UPAGE promptly, since only mapped frames are
+   considered for eviction.  Returns a null pointer if no frame
+   can be obtained. */
+void *
+frame_alloc (void *upage, enum palloc_flags flags) 
+{
+  struct frame *f;
+  void *kpage;
+
+  lock_acquire (&frame_lock);
+  kpage = palloc_get_page (PAL_USER | (flags & PAL_ZERO));
+  if (kpage != NULL) 
+    {
+      f = malloc (sizeof *f);
+      if (f == NULL) 
+        {
+          palloc_free_page (kpage);
+          lock_release (&frame_lock);
+          return NULL;
+        }
+      f->kpage = kpage;
+      hash_insert (&frames, &f->hash_elem);
+      list_insert (hand, &f->list_elem);
+    }
+  else 
+    {
+      f = evict ();
+      if (f == NULL) 
+        {
+          lock_release (&frame_lock);
+          return NULL;
+        }
+      if (flags & PAL_ZERO)
+        memset (f->kpage, 0, PGSIZE);
+    }
+  f->owner = thread_current ();
+  f->upage = upage;
+  f->pin_cnt = 0;
+  lock_release (&frame_lock);
+
+  return f->kpage;
+}
+
+/* Returns frame KPAGE, obtained from frame_alloc(), to the user
+   pool. */
+void
+frame_free (void *kpage) 
+{
+  struct frame *f;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL);
+  if (hand == &f->list_elem)
+    hand = list_next (hand);
+  list_remove (&f->list_elem);
+  hash_delete (&frames, &f->hash_elem);
+  palloc_free_page (kpage);
+  lock_release (&frame_lock);
+
+  free (f);
+}
+
+/* Records that frame KPAGE is mapped by process T, at UPAGE.
+   While KPAGE has an entry in cow.c's table of shared frames,
+   that entry says who maps it instead, but this record must be
+   right by the time the entry goes away. */
+void
+frame_set_owner (void *kpage, struct thread *t, void *upage) 
+{
+  struct frame *f;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL);
+  f->owner = t;
+  f->upage = upage;
+  lock_release (&frame_lock);
+}
+
+/* Returns the process recorded as mapping frame KPAGE, and
+   stores the address at which it does so in *UPAGE. */
+struct thread *
+frame_get_owner (void *kpage, void **upage) 
+{
+  struct frame *f;
+  struct thread *t;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL);
+  t = f->owner;
+  *upage = f->upage;
+  lock_release (&frame_lock);
+
+  return t;
+}
+
+/* Keeps frame KPAGE from being evicted until a matching call to
+   frame_unpin(). */
+void
+frame_pin (void *kpage) 
+{
+  struct frame *f;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL);
+  f->pin_cnt++;
+  lock_release (&frame_lock);
+}
+
+/* Undoes one call to frame_pin() for frame KPAGE. */
+void
+frame_unpin (void *kpage) 
+{
+  struct frame *f;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL && f->pin_cnt > 0);
+  f->pin_cnt--;
+  lock_release (&frame_lock);
+}
+
+/* Returns true if frame KPAGE is pinned. */
+bool
+frame_is_pinned (void *kpage) 
+{
+  struct frame *f;
+  bool pinned;
+
+  lock_acquire (&frame_lock);
+  f = lookup (kpage);
+  ASSERT (f != NULL);
+  pinned = f->pin_cnt > 0;
+  lock_release (&frame_lock);
+
+  return pinned;
+}
+
+/* Chooses a frame with the clock algorithm, evicts its page,
+   and returns the frame with its old owner's mapping gone.
+   Passes over frames that are pinned, mapped by more than one
+   process, or whose owner is busy with its page table, and
+   gives a second chance to frames
+   that were accessed since the hand last came by.  Returns a
+   null pointer if two sweeps find nothing to evict.  frame_lock
+   must be held. */
+static struct frame *
+evict (void) 
+{
+  size_t i, n = 2 * hash_size (&frames);
+
+  for (i = 0; i < n; i++) 
+    {
+      struct frame *f;
+      struct thread *owner;
+      void *upage;
+      bool locked;
+
+      if (hand == list_end (&clock))
+        hand = list_begin (&clock);
+      if (hand == list_end (&clock))
+        return NULL;
+      f = list_entry (hand, struct frame, list_elem);
+      hand = list_next (hand);
+
+      if (f->pin_cnt > 0)
+        continue;
+
+      /* The owner may itself be waiting for this frame_alloc(),
+         in which case it already holds its page_lock. */
+      if (cow_owner (f->kpage, &owner, &upage, &locked)) 
+        {
+          /* A frame that has been shared is evictable once one
+             process is left mapping it.  If page_evict() gets as
+             far as forgetting that it was shared, our record
+             must then be right. */
+          if (owner == NULL)
+            continue;
+          f->owner = owner;
+          f->upage = upage;
+        }
+      else 
+        {
+          owner = f->owner;
+          upage = f->upage;
+          locked = lock_held_by_current_thread (&owner->page_lock);
+          if (!locked && !lock_try_acquire (&owner->page_lock))
+            continue;
+        }
+
+      /* A frame not yet mapped is still being filled in. */
+      if (owner->pagedir != NULL
+          && pagedir_get_page (owner->pagedir, upage) == f->kpage) 
+        {
+          if (pagedir_is_accessed (owner->pagedir, upage))
+            pagedir_set_accessed (owner->pagedir, upage, false);
+          else if (page_evict (owner, upage, f->kpage)) 
+            {
+              if (!locked)
+                lock_release (&owner->page_lock);
+              return f;
+            }
+        }
+
+      if (!locked)
+        lock_release (&owner->page_lock);
+    }
+  return NULL;
+}
+
+/* Returns the frame for KPAGE.  frame_lock must be held. */
+static struct frame *
+lookup (void *kpage) 
+{
+  struct frame key;
+  struct hash_elem *e;
+
+  key.kpage = kpage;
+  e = hash_find (&frames, &key.hash_elem);
+  return e != NULL ? hash_entry (e, struct frame, hash_elem) : NULL;
+}
+
+/* Returns a hash value for frame E. */
+static unsigned
+frame_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct frame *f = hash_entry (e, struct frame, hash_elem);
+  return hash_bytes (&f->kpage, sizeof f->kpage);
+}
+
+/* Returns true if frame A precedes frame B. */
+static bool
+frame_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct frame *a = hash_entry (a_, struct frame, hash_elem);
+  const struct frame *b = hash_entry (b_, struct frame, hash_elem);
+  return a->kpage < b->kpage;
+}
@@ -0,0 +1,25 @@
+#ifndef VM_FRAME_H
+#define VM_FRAME_H
+
+#include <stdbool.h>
+#include "threads/palloc.h"
+
+struct thread;
+
+/* Frame table.
+
+   Tracks every frame in the user pool.  When the pool runs dry,
+   frame_alloc() takes a frame away from some process with the
+   clock algorithm, writing the page to swap first if it has no
+   other copy. */
+
+void frame_init (void);
+void *frame_alloc (void *upage, enum palloc_flags);
+void frame_free (void *kpage);
+void frame_set_owner (void *kpage, struct thread *, void *upage);
+struct thread *frame_get_owner (void *kpage, void **upage);
+void frame_pin (void *kpage);
+void frame_unpin (void *kpage);
+bool frame_is_pinned (void *kpage);
+
+#endif /* vm/frame.h */
@@ -0,0 +1,161 @@
+#include "vm/mmap.h"
+#include <debug.h>
+#include <list.h>
+#include <stdint.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/page.h"
+
+/* A memory-mapped file. */
+struct mapping
+  {
+    struct list_elem elem;      /* Element in thread's mappings. */
+    int id;                     /* Mapping id. */
+    struct file *file;          /* File, opened for the mapping alone. */
+    uint8_t *base;              /* First user page. */
+    size_t page_cnt;            /* Number of pages. */
+  };
+
+static struct mapping *lookup (int mapid);
+static void unmap (struct mapping *);
+
+/* Maps FILE into the running process at user page ADDR and
+   returns an id for the mapping.  The mapping has its own
+   opening of FILE, so it lasts until it is unmapped even if FILE
+   is closed.  Returns -1 if FILE is empty, if ADDR is null or not
+   page-aligned, if any page the file would occupy is already in
+   use, or if memory allocation fails. */
+int
+mmap_map (struct file *file, void *addr) 
+{
+  struct thread *t = thread_current ();
+  struct mapping *m;
+  off_t length = file_length (file);
+  off_t ofs;
+
+  if (addr == NULL || pg_ofs (addr) != 0 || length == 0
+      || !is_user_vaddr (addr)
+      || (size_t) length > (size_t) ((uint8_t *) PHYS_BASE
+                                     - (uint8_t *) addr))
+    return -1;
+
+  m = malloc (sizeof *m);
+  if (m == NULL)
+    return -1;
+  m->file = file_reopen (file);
+  if (m->file == NULL) 
+    {
+      free (m);
+      return -1;
+    }
+  m->base = addr;
+  m->page_cnt = 0;
+
+  for (ofs = 0; ofs < length; ofs += PGSIZE) 
+    {
+      size_t read_bytes = length - ofs < PGSIZE ? length - ofs : PGSIZE;
+
+      if (!page_add_mmap (m->base + ofs, file_get_inode (m->file), ofs,
+                          read_bytes)) 
+        {
+          unmap (m);
+          return -1;
+        }
+      m->page_cnt++;
+    }
+
+  m->id = t->next_mapid++;
+  list_push_back (&t->mappings, &m->elem);
+  return m->id;
+}
+
+/* Removes mapping MAPID from the running process, writing back
+   its modified pages.  Does nothing if there is no such
+   mapping. */
+void
+mmap_unmap (int mapid) 
+{
+  struct mapping *m = lookup (mapid);
+
+  if (m != NULL) 
+    {
+      list_remove (&m->elem);
+      unmap (m);
+    }
+}
+
+/* Removes every mapping from the running process, as
+   mmap_unmap() does, for process exit. */
+void
+mmap_unmap_all (void) 
+{
+  struct thread *t = thread_current ();
+
+  while (!list_empty (&t->mappings))
+    unmap (list_entry (list_pop_front (&t->mappings),
+                       struct mapping, elem));
+}
+
+/* Gives DST, a new process forked from SRC, a copy of each of
+   SRC's mappings.  The pages themselves are copied along with
+   the rest of SRC's supplemental page table.  Returns true if
+   successful, false if memory allocation fails. */
+bool
+mmap_copy (struct thread *dst, struct thread *src) 
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&src->mappings); e != list_end (&src->mappings);
+       e = list_next (e)) 
+    {
+      struct mapping *m = list_entry (e, struct mapping, elem);
+      struct mapping *copy = malloc (sizeof *copy);
+
+      if (copy == NULL)
+        return false;
+      *copy = *m;
+      copy->file = file_reopen (m->file);
+      if (copy->file == NULL) 
+        {
+          free (copy);
+          return false;
+        }
+      list_push_back (&dst->mappings, &copy->elem);
+    }
+  dst->next_mapid = src->next_mapid;
+  return true;
+}
+
+/* Returns the running process's mapping with id MAPID, or a null
+   pointer if there is none. */
+static struct mapping *
+lookup (int mapid) 
+{
+  struct thread *t = thread_current ();
+  struct list_elem *e;
+
+  for (e = list_begin (&t->mappings); e != list_end (&t->mappings);
+       e = list_next (e)) 
+    {
+      struct mapping *m = list_entry (e, struct mapping, elem);
+      if (m->id == mapid)
+        return m;
+    }
+  return NULL;
+}
+
+/* Removes M's pages from the running process, writing back the
+   ones that were modified, then closes its file and frees it.
+   M must not be in the process's list of mappings. */
+static void
+unmap (struct mapping *m) 
+{
+  size_t i;
+
+  for (i = 0; i < m->page_cnt; i++)
+    page_remove (m->base + i * PGSIZE);
+  file_close (m->file);
+  free (m);
+}
@@ -0,0 +1,21 @@
+#ifndef VM_MMAP_H
+#define VM_MMAP_H
+
+#include <stdbool.h>
+
+struct file;
+struct thread;
+
+/* Memory-mapped files.
+
+   A mapping covers a whole file, laid out in consecutive user
+   pages.  Each page is read in from the file when it is first
+   touched, and written back to the file, if it has been
+   modified, when it is evicted or unmapped. */
+
+int mmap_map (struct file *, void *addr);
+void mmap_unmap (int mapid);
+void mmap_unmap_all (void);
+bool mmap_copy (struct thread *dst, struct thread *src);
+
+#endif /* vm/mmap.h */
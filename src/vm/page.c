@@ -0,0 +1,608 @@
+#include "vm/page.h"
+#include <advice.h>
+#include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "devices/block.h"
+#include "filesys/inode.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/cow.h"
+#include "userprog/pagedir.h"
+#include "vm/frame.h"
+#include "vm/swap.h"
+
+/* A process's supplemental page table and page directory are
+   changed by the process itself, from system calls and from page
+   faults it takes, and by any thread that evicts one of its
+   frames.  The process's page_lock keeps the two apart. */
+
+/* How far below the stack pointer an access may be and still
+   be taken as a push: PUSHA stores 32 bytes below ESP before it
+   moves ESP. */
+#define STACK_SLOP 32
+
+/* Number of pages of file data to prefetch into the buffer
+   cache after a fault on a page advised ADV_SEQUENTIAL. */
+#define READAHEAD_PAGES 2
+
+/* Maximum size of a user stack, in pages.  8 MB by default. */
+size_t page_stack_limit = 2048;
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+static hash_action_func page_destroy;
+static struct page *page_lookup (struct hash *, const void *upage);
+static struct page *page_create (struct thread *, void *upage,
+                                 struct inode *, off_t ofs,
+                                 size_t read_bytes, bool writable);
+static bool load_page (struct thread *, void *upage, bool write);
+static void drop_page (struct thread *, struct page *);
+
+/* Creates and returns a new, empty supplemental page table, or
+   a null pointer if memory allocation fails. */
+struct hash *
+page_table_create (void) 
+{
+  struct hash *pages = malloc (sizeof *pages);
+  if (pages != NULL && !hash_init (pages, page_hash, page_less, NULL))
+    {
+      free (pages);
+      pages = NULL;
+    }
+  return pages;
+}
+
+/* Adds a copy of every page in SRC to DST, which should be
+   empty, for fork().  The copies refer to the same inodes as the
+   originals, which stay open as long as the child has the
+   executable open.  A page in swap gets a swap slot of its own.
+   The caller must hold the page_lock of SRC's process.  Returns
+   true if successful, false if memory or swap allocation
+   fails. */
+bool
+page_table_copy (struct hash *dst, struct hash *src) 
+{
+  struct hash_iterator i;
+
+  hash_first (&i, src);
+  while (hash_next (&i)) 
+    {
+      struct page *p = hash_entry (hash_cur (&i), struct page, hash_elem);
+      struct page *copy = malloc (sizeof *copy);
+      if (copy == NULL)
+        return false;
+      *copy = *p;
+      if (p->swap_slot != SWAP_ERROR) 
+        {
+          copy->swap_slot = swap_dup (p->swap_slot);
+          if (copy->swap_slot == SWAP_ERROR) 
+            {
+              free (copy);
+              return false;
+            }
+        }
+      hash_insert (dst, &copy->hash_elem);
+    }
+  return true;
+}
+
+/* Destroys supplemental page table PAGES, releasing any swap
+   slots it holds.  The frames of any pages that are present
+   belong to the page directory and are freed with it. */
+void
+page_table_destroy (struct hash *pages) 
+{
+  if (pages != NULL) 
+    {
+      hash_destroy (pages, page_destroy);
+      free (pages);
+    }
+}
+
+/* Records that user page UPAGE in the running process is to be
+   filled, on first touch, with READ_BYTES bytes read from INODE
+   starting at offset OFS, followed by zeros.  Returns true if
+   successful, false if UPAGE already has contents or memory
+   allocation fails. */
+bool
+page_add_file (void *upage, struct inode *inode, off_t ofs,
+               size_t read_bytes, bool writable) 
+{
+  struct thread *t = thread_current ();
+  bool success;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  lock_acquire (&t->page_lock);
+  success = (pagedir_get_page (t->pagedir, upage) == NULL
+             && page_create (t, upage, inode, ofs, read_bytes,
+                             writable) != NULL);
+  lock_release (&t->page_lock);
+
+  return success;
+}
+
+/* Records that user page UPAGE in the running process belongs
+   to a memory-mapped file, holding the READ_BYTES bytes of
+   INODE at offset OFS followed by zeros.  The page is read in on
+   first touch and written back to INODE when it is evicted or
+   removed, if it has been modified.  Returns true if successful,
+   false if UPAGE already has contents or memory allocation
+   fails. */
+bool
+page_add_mmap (void *upage, struct inode *inode, off_t ofs,
+               size_t read_bytes) 
+{
+  struct thread *t = thread_current ();
+  struct page *p = NULL;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  lock_acquire (&t->page_lock);
+  if (pagedir_get_page (t->pagedir, upage) == NULL)
+    p = page_create (t, upage, inode, ofs, read_bytes, true);
+  if (p != NULL)
+    p->mapped = true;
+  lock_release (&t->page_lock);
+
+  return p != NULL;
+}
+
+/* Adds a zeroed, writable page at UPAGE in the running process,
+   for its stack.  Returns true if successful, false if UPAGE
+   already has contents or memory allocation fails. */
+bool
+page_add_stack (void *upage) 
+{
+  struct thread *t = thread_current ();
+  struct page *p;
+  bool success = false;
+
+  ASSERT (pg_ofs (upage) == 0);
+
+  lock_acquire (&t->page_lock);
+  if (pagedir_get_page (t->pagedir, upage) == NULL) 
+    {
+      p = page_create (t, upage, NULL, 0, 0, true);
+      if (p != NULL) 
+        {
+          success = load_page (t, upage, true);
+          if (!success) 
+            {
+              hash_delete (t->pages, &p->hash_elem);
+              free (p);
+            }
+        }
+    }
+  lock_release (&t->page_lock);
+
+  return success;
+}
+
+/* Removes user page UPAGE from the running process, first
+   writing it back to its file if it belongs to a memory-mapped
+   file and has been modified.  Does nothing if UPAGE has no
+   supplemental page table entry. */
+void
+page_remove (void *upage) 
+{
+  struct thread *t = thread_current ();
+  struct page *p;
+  void *kpage;
+
+  lock_acquire (&t->page_lock);
+  p = page_lookup (t->pages, upage);
+  if (p != NULL) 
+    {
+      kpage = pagedir_get_page (t->pagedir, upage);
+      if (kpage != NULL) 
+        {
+          if (p->mapped && pagedir_is_dirty (t->pagedir, upage))
+            inode_write_at (p->inode, kpage, p->read_bytes, p->ofs);
+          pagedir_clear_page (t->pagedir, upage);
+          cow_release (kpage, upage);
+        }
+      hash_delete (t->pages, &p->hash_elem);
+      page_destroy (&p->hash_elem, NULL);
+    }
+  lock_release (&t->page_lock);
+}
+
+/* Brings in the page containing user address UADDR in the
+   running process, if it has a supplemental page table entry
+   and is not present, for an access that writes it if WRITE is
+   true.  Returns true if successful, false if UADDR is not in
+   such a page or the page cannot be brought in. */
+bool
+page_in (const void *uaddr, bool write) 
+{
+  struct thread *t = thread_current ();
+  bool success;
+
+  if (t->pages == NULL || !is_user_vaddr (uaddr))
+    return false;
+
+  lock_acquire (&t->page_lock);
+  success = load_page (t, pg_round_down (uaddr), write);
+  lock_release (&t->page_lock);
+
+  return success;
+}
+
+/* Adds a zeroed page to the stack of the running process to
+   hold user address UADDR, if UADDR looks like an access to the
+   stack given user stack pointer ESP, and is within
+   page_stack_limit pages of the top of user memory.  Returns true
+   if successful, false if UADDR is not such an address, already
+   has contents, or no frame is free.
+
+   USER is true for an access by a user instruction, with ESP
+   its stack pointer, which may push up to STACK_SLOP bytes below
+   ESP.  Otherwise the kernel is accessing UADDR on behalf of a
+   system call, and ESP is the stack pointer saved when the
+   process entered the kernel.  No push is under way then, so
+   only UADDR at or above ESP is on the stack; anything below is
+   an invalid buffer, not stack that the process is growing. */
+bool
+page_grow_stack (const void *uaddr, const void *esp, bool user) 
+{
+  struct thread *t = thread_current ();
+  void *upage = pg_round_down (uaddr);
+  const uint8_t *bottom = (const uint8_t *) esp - (user ? STACK_SLOP : 0);
+
+  if (t->pages == NULL
+      || !is_user_vaddr (uaddr)
+      || (const uint8_t *) uaddr < bottom
+      || (size_t) ((uint8_t *) PHYS_BASE - (uint8_t *) upage)
+         > page_stack_limit * PGSIZE)
+    return false;
+
+  return page_add_stack (upage);
+}
+
+/* Handles a write to user address UADDR in the running process
+   that faulted on a present page, by giving the process its own
+   copy if the page is copy-on-write.  Returns true if
+   successful, false if the page may not be written or no frame
+   is free. */
+bool
+page_unshare (const void *uaddr) 
+{
+  struct thread *t = thread_current ();
+  bool success;
+
+  if (t->pagedir == NULL || !is_user_vaddr (uaddr))
+    return false;
+
+  lock_acquire (&t->page_lock);
+  success = pagedir_break_cow (t->pagedir, uaddr);
+  lock_release (&t->page_lock);
+
+  return success;
+}
+
+/* Makes sure the page containing user address UADDR in the
+   running process is present, and, if WRITE, that the process
+   may write it, then keeps its frame from being evicted until
+   page_unpin().  The kernel can then access the page without
+   faulting, even while holding locks.  Returns true if
+   successful, false if UADDR is not a valid address for the
+   access. */
+bool
+page_pin (const void *uaddr, bool write) 
+{
+  struct thread *t = thread_current ();
+  void *upage = pg_round_down (uaddr);
+  void *kpage;
+
+  if (t->pages == NULL || !is_user_vaddr (uaddr))
+    return false;
+
+  lock_acquire (&t->page_lock);
+  kpage = pagedir_get_page (t->pagedir, upage);
+  if (kpage == NULL && load_page (t, upage, write))
+    kpage = pagedir_get_page (t->pagedir, upage);
+  if (kpage != NULL && write && !pagedir_is_writable (t->pagedir, upage))
+    kpage = (pagedir_break_cow (t->pagedir, upage)
+             ? pagedir_get_page (t->pagedir, upage) : NULL);
+  if (kpage != NULL && kpage != cow_zero_page ())
+    frame_pin (kpage);
+  lock_release (&t->page_lock);
+
+  return kpage != NULL;
+}
+
+/* Undoes page_pin() for the page containing UADDR. */
+void
+page_unpin (const void *uaddr) 
+{
+  void *kpage = pagedir_get_page (thread_current ()->pagedir,
+                                  pg_round_down (uaddr));
+
+  ASSERT (kpage != NULL);
+  if (kpage != cow_zero_page ())
+    frame_unpin (kpage);
+}
+
+/* Unmaps user page UPAGE in thread T, which is mapped to frame
+   KPAGE, so that the frame can be reused.  If the page has been
+   written, it goes back to its file if it is part of a
+   memory-mapped file, or to a swap slot otherwise; either way it
+   can then be brought back from where it went.  The caller must
+   hold T's page_lock.  Returns true if successful, false if the
+   page must stay: it is shared, or it needs a swap slot and none
+   is free. */
+bool
+page_evict (struct thread *t, void *upage, void *kpage) 
+{
+  struct page *p = page_lookup (t->pages, upage);
+  enum intr_level old_level;
+  bool dirty;
+
+  ASSERT (lock_held_by_current_thread (&t->page_lock));
+
+  if (p == NULL || !cow_evict (kpage))
+    return false;
+
+  /* Read the dirty bit and unmap together, so that T cannot
+     dirty a page we have decided is clean. */
+  old_level = intr_disable ();
+  dirty = pagedir_is_dirty (t->pagedir, upage);
+  if (!dirty)
+    pagedir_clear_page (t->pagedir, upage);
+  intr_set_level (old_level);
+
+  if (dirty && p->mapped) 
+    {
+      pagedir_clear_page (t->pagedir, upage);
+      inode_write_at (p->inode, kpage, p->read_bytes, p->ofs);
+    }
+  else if (dirty) 
+    {
+      size_t slot = swap_alloc ();
+      if (slot == SWAP_ERROR)
+        return false;
+      pagedir_clear_page (t->pagedir, upage);
+      swap_write (slot, kpage);
+      p->swap_slot = slot;
+    }
+  return true;
+}
+
+/* Applies ADVICE, one of the ADV_* values in lib/advice.h,
+   to the pages in the LENGTH bytes of the running process's
+   address space starting at page UPAGE.  ADV_NORMAL,
+   ADV_RANDOM, and ADV_SEQUENTIAL are recorded in each page and
+   apply to its later faults: after a fault on a page from a
+   file, ADV_SEQUENTIAL starts reading the file data that follows
+   into the buffer cache, while the other two bring in just the
+   one page.  ADV_WILLNEED starts reading each page from a file
+   that is not present into the buffer cache, so that touching it
+   later does not wait for the disk.  ADV_DONTNEED evicts each
+   page at once, as the frame table would, so its frame can be
+   reused; the page's contents are kept.  The range must lie in
+   user memory.  Returns true if successful, false if some page
+   in the range is not part of the address space, after applying
+   ADVICE to the others. */
+bool
+page_advise (void *upage, size_t length, int advice) 
+{
+  struct thread *t = thread_current ();
+  uint8_t *end = (uint8_t *) upage + length;
+  uint8_t *va;
+  bool success = true;
+
+  ASSERT (pg_ofs (upage) == 0);
+
+  lock_acquire (&t->page_lock);
+  for (va = upage; va < end; va += PGSIZE) 
+    {
+      struct page *p = page_lookup (t->pages, va);
+
+      if (p == NULL) 
+        {
+          success = false;
+          continue;
+        }
+
+      switch (advice) 
+        {
+        case ADV_WILLNEED:
+          if (p->inode != NULL && p->read_bytes > 0
+              && p->swap_slot == SWAP_ERROR
+              && pagedir_get_page (t->pagedir, va) == NULL)
+            inode_readahead (p->inode, p->ofs,
+                             DIV_ROUND_UP (p->read_bytes, BLOCK_SECTOR_SIZE));
+          break;
+
+        case ADV_DONTNEED:
+          drop_page (t, p);
+          break;
+
+        default:
+          p->advice = advice;
+          break;
+        }
+    }
+  lock_release (&t->page_lock);
+
+  return success;
+}
+
+/* Brings in user page UPAGE for T, the running thread, if it
+   has a supplemental page table entry and is not present.  A
+   page of zeros that is only being read is mapped to the shared
+   zero page rather than given a frame; if WRITE is true, it gets
+   a zeroed frame at once, to save a second fault.  T's page_lock
+   must be held.  Returns true if successful, false otherwise. */
+static bool
+load_page (struct thread *t, void *upage, bool write) 
+{
+  struct page *p = page_lookup (t->pages, upage);
+  uint8_t *kpage;
+
+  if (p == NULL || pagedir_get_page (t->pagedir, upage) != NULL)
+    return false;
+
+  if (p->swap_slot != SWAP_ERROR) 
+    {
+      kpage = frame_alloc (upage, 0);
+      if (kpage == NULL)
+        return false;
+      swap_read (p->swap_slot, kpage);
+    }
+  else if (p->inode == NULL || p->read_bytes == 0) 
+    {
+      if (!write)
+        return pagedir_set_zero_page (t->pagedir, upage, p->writable);
+      kpage = frame_alloc (upage, PAL_ZERO);
+      if (kpage == NULL)
+        return false;
+    }
+  else 
+    {
+      /* Read-only pages are shared with every other process
+         that has the same page of the same file loaded. */
+      kpage = NULL;
+      if (!p->writable)
+        kpage = cow_get_text (p->inode, p->ofs, p->read_bytes, upage);
+
+      if (kpage == NULL) 
+        {
+          kpage = frame_alloc (upage, 0);
+          if (kpage == NULL)
+            return false;
+          if (inode_read_at (p->inode, kpage, p->read_bytes, p->ofs)
+              != (off_t) p->read_bytes) 
+            {
+              frame_free (kpage);
+              return false;
+            }
+          memset (kpage + p->read_bytes, 0, PGSIZE - p->read_bytes);
+
+          if (!p->writable)
+            kpage = cow_add_text (kpage, p->inode, p->ofs, p->read_bytes,
+                                  upage);
+        }
+
+      if (p->advice == ADV_SEQUENTIAL)
+        inode_readahead (p->inode, p->ofs + PGSIZE,
+                         READAHEAD_PAGES * PGSIZE / BLOCK_SECTOR_SIZE);
+    }
+
+  if (!pagedir_set_page (t->pagedir, upage, kpage, p->writable)) 
+    {
+      cow_release (kpage, upage);
+      return false;
+    }
+
+  /* The frame now holds the only copy of a page that came from
+     swap, so mark it dirty to send it back there if it is
+     evicted again. */
+  if (p->swap_slot != SWAP_ERROR) 
+    {
+      swap_free (p->swap_slot);
+      p->swap_slot = SWAP_ERROR;
+      pagedir_set_dirty (t->pagedir, upage, true);
+    }
+  return true;
+}
+
+/* Evicts page P of T, the running thread, if it is present, not
+   pinned, and no other process maps its frame, and frees the
+   frame.  A pinned frame is in use by a system call, here or in
+   a process sharing it, so it is left alone; the advice only
+   says the contents are not needed.  T's page_lock must be
+   held. */
+static void
+drop_page (struct thread *t, struct page *p) 
+{
+  void *kpage = pagedir_get_page (t->pagedir, p->upage);
+
+  if (kpage == NULL || kpage == cow_zero_page ()
+      || frame_is_pinned (kpage))
+    return;
+
+  /* If KPAGE was shared, page_evict() may forget that even if it
+     then fails, and the frame table's record must be right from
+     then on. */
+  frame_set_owner (kpage, t, p->upage);
+  if (page_evict (t, p->upage, kpage))
+    frame_free (kpage);
+}
+
+/* Adds a page for UPAGE to T's supplemental page table, to be
+   filled as described for page_add_file(), and returns it.
+   Returns a null pointer if UPAGE already has an entry or memory
+   allocation fails.  T's page_lock must be held. */
+static struct page *
+page_create (struct thread *t, void *upage, struct inode *inode,
+             off_t ofs, size_t read_bytes, bool writable) 
+{
+  struct page *p = malloc (sizeof *p);
+  if (p == NULL)
+    return NULL;
+
+  p->upage = upage;
+  p->inode = inode;
+  p->ofs = ofs;
+  p->read_bytes = read_bytes;
+  p->writable = writable;
+  p->mapped = false;
+  p->advice = ADV_NORMAL;
+  p->swap_slot = SWAP_ERROR;
+  if (hash_insert (t->pages, &p->hash_elem) != NULL) 
+    {
+      free (p);
+      return NULL;
+    }
+  return p;
+}
+
+/* Returns the page in PAGES for user page UPAGE, or a null
+   pointer if there is none. */
+static struct page *
+page_lookup (struct hash *pages, const void *upage) 
+{
+  struct page p;
+  struct hash_elem *e;
+
+  p.upage = (void *) upage;
+  e = hash_find (pages, &p.hash_elem);
+  return e != NULL ? hash_entry (e, struct page, hash_elem) : NULL;
+}
+
+/* Returns a hash value for page E. */
+static unsigned
+page_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct page *p = hash_entry (e, struct page, hash_elem);
+  return hash_bytes (&p->upage, sizeof p->upage);
+}
+
+/* Returns true if page A precedes page B. */
+static bool
+page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED) 
+{
+  const struct page *a = hash_entry (a_, struct page, hash_elem);
+  const struct page *b = hash_entry (b_, struct page, hash_elem);
+  return a->upage < b->upage;
+}
+
+/* Frees page E and its swap slot, if any. */
+static void
+page_destroy (struct hash_elem *e, void *aux UNUSED) 
+{
+  struct page *p = hash_entry (e, struct page, hash_elem);
+
+  if (p->swap_slot != SWAP_ERROR)
+    swap_free (p->swap_slot);
+  free (p);
+}
@@ -0,0 +1,57 @@
+#ifndef VM_PAGE_H
+#define VM_PAGE_H
+
+#include <hash.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct thread;
+
+/* Supplemental page table.
+
+   Records, for each page of a process's user address space, how
+   to bring the page in when it is touched and not present:
+   either its first contents, from a file or all zeros, or the
+   swap slot it was evicted to.  A page of a memory-mapped file
+   never goes to swap; it is written back to the file instead.  The page directory still says
+   which pages are present; this table says what belongs in the
+   ones that are not. */
+
+/* A user page. */
+struct page
+  {
+    struct hash_elem hash_elem; /* Element in supplemental page table. */
+    void *upage;                /* User virtual address. */
+    struct inode *inode;        /* File to read from, or null for zeros. */
+    off_t ofs;                  /* Offset in file of page's first byte. */
+    size_t read_bytes;          /* Bytes read from file; the rest are zero. */
+    bool writable;              /* May the process write the page? */
+    bool mapped;                /* Part of a memory-mapped file? */
+    int advice;                 /* Access pattern, as an ADV_* value. */
+    size_t swap_slot;           /* Slot holding the page, or SWAP_ERROR. */
+  };
+
+struct hash *page_table_create (void);
+bool page_table_copy (struct hash *dst, struct hash *src);
+void page_table_destroy (struct hash *);
+
+/* Maximum size of a user stack, in pages.
+   Controlled by kernel command-line option "-sl=COUNT". */
+extern size_t page_stack_limit;
+
+bool page_add_file (void *upage, struct inode *, off_t ofs,
+                    size_t read_bytes, bool writable);
+bool page_add_mmap (void *upage, struct inode *, off_t ofs,
+                    size_t read_bytes);
+bool page_add_stack (void *upage);
+void page_remove (void *upage);
+bool page_in (const void *uaddr, bool write);
+bool page_grow_stack (const void *uaddr, const void *esp, bool user);
+bool page_unshare (const void *uaddr);
+bool page_pin (const void *uaddr, bool write);
+void page_unpin (const void *uaddr);
+bool page_evict (struct thread *, void *upage, void *kpage);
+bool page_advise (void *upage, size_t length, int advice);
+
+#endif /* vm/page.h */
@@ -0,0 +1,112 @@
+#include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include "devices/block.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Number of sectors in a swap slot. */
+#define SECTORS_PER_SLOT (PGSIZE / BLOCK_SECTOR_SIZE)
+
+/* The swap device, or a null pointer if there is none. */
+static struct block *swap_device;
+
+/* Slots in use, one bit each.  Null if there is no swap
+   device. */
+static struct bitmap *used_slots;
+
+/* Protects used_slots. */
+static struct lock swap_lock;
+
+/* Finds the swap device and sets up its slot bitmap.  Without a
+   swap device, swap_alloc() always fails, so only pages that can
+   be read back from a file are ever evicted. */
+void
+swap_init (void) 
+{
+  lock_init (&swap_lock);
+  swap_device = block_get_role (BLOCK_SWAP);
+  if (swap_device == NULL)
+    return;
+
+  used_slots = bitmap_create (block_size (swap_device) / SECTORS_PER_SLOT);
+  if (used_slots == NULL)
+    PANIC ("out of memory for swap bitmap");
+}
+
+/* Reserves a swap slot and returns it, or SWAP_ERROR if every
+   slot is in use. */
+size_t
+swap_alloc (void) 
+{
+  size_t slot = SWAP_ERROR;
+
+  if (used_slots != NULL) 
+    {
+      lock_acquire (&swap_lock);
+      slot = bitmap_scan_and_flip (used_slots, 0, 1, false);
+      lock_release (&swap_lock);
+      if (slot == BITMAP_ERROR)
+        slot = SWAP_ERROR;
+    }
+  return slot;
+}
+
+/* Writes the page at KPAGE to swap slot SLOT. */
+void
+swap_write (size_t slot, const void *kpage) 
+{
+  size_t i;
+
+  ASSERT (slot != SWAP_ERROR);
+  for (i = 0; i < SECTORS_PER_SLOT; i++)
+    block_write (swap_device, slot * SECTORS_PER_SLOT + i,
+                 (const uint8_t *) kpage + i * BLOCK_SECTOR_SIZE);
+}
+
+/* Reads swap slot SLOT into the page at KPAGE. */
+void
+swap_read (size_t slot, void *kpage) 
+{
+  size_t i;
+
+  ASSERT (slot != SWAP_ERROR);
+  for (i = 0; i < SECTORS_PER_SLOT; i++)
+    block_read (swap_device, slot * SECTORS_PER_SLOT + i,
+                (uint8_t *) kpage + i * BLOCK_SECTOR_SIZE);
+}
+
+/* Copies swap slot SLOT into a newly reserved slot and returns
+   the new slot, or SWAP_ERROR if no slot or no buffer is
+   available. */
+size_t
+swap_dup (size_t slot) 
+{
+  size_t copy = SWAP_ERROR;
+  void *buffer = palloc_get_page (0);
+
+  if (buffer != NULL) 
+    {
+      copy = swap_alloc ();
+      if (copy != SWAP_ERROR) 
+        {
+          swap_read (slot, buffer);
+          swap_write (copy, buffer);
+        }
+      palloc_free_page (buffer);
+    }
+  return copy;
+}
+
+/* Releases swap slot SLOT. */
+void
+swap_free (size_t slot) 
+{
+  ASSERT (slot != SWAP_ERROR);
+
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (used_slots, slot));
+  bitmap_reset (used_slots, slot);
+  lock_release (&swap_lock);
+}
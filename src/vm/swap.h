@@ -0,0 +1,18 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+
+#include <stddef.h>
+
+/* Swap slots on the swap block device, one page each. */
+
+/* Returned by swap_alloc() when no slot is free. */
+#define SWAP_ERROR SIZE_MAX
+
+void swap_init (void);
+size_t swap_alloc (void);
+void swap_write (size_t slot, const void *kpage);
+void swap_read (size_t slot, void *kpage);
+size_t swap_dup (size_t slot);
+void swap_free (size_t slot);
+
+#endif /* vm/swap.h */